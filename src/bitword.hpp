@@ -0,0 +1,54 @@
+/// bitword.hpp
+///
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+
+#ifndef BITWORD_H
+#define BITWORD_H
+
+#include <cstdint>
+
+/**
+ * @brief Helpers for bit vectors packed into 64-bit words.
+ *
+ * Bit `i` of a packed vector lives in word `i / 64` at position `i % 64`.
+ * Bits past the end of the vector in the last word are always kept at 0 so
+ * that words can be AND-ed together without masking the tail.
+ */
+namespace BitWord {
+
+    const int BITS_PER_WORD = 64;
+
+    // Returns the number of words needed to hold `num_bits` bits.
+    inline int numWords(int num_bits) {
+        return (num_bits + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    }
+
+    inline bool test(const uint64_t* words, int bit) {
+        return (words[bit / BITS_PER_WORD] >> (bit % BITS_PER_WORD)) & 1;
+    }
+
+    inline void set(uint64_t* words, int bit) {
+        words[bit / BITS_PER_WORD] |= (uint64_t)1 << (bit % BITS_PER_WORD);
+    }
+
+    // Index of the lowest set bit. `word` must not be 0.
+    inline int countTrailingZeros(uint64_t word) {
+        return __builtin_ctzll(word);
+    }
+
+    // Number of set bits. Without the POPCNT instruction the builtin becomes a library call, so
+    // fall back to the branch-free bit-twiddling version instead.
+    inline int popcount(uint64_t word) {
+#ifdef __POPCNT__
+        return __builtin_popcountll(word);
+#else
+        word = word - ((word >> 1) & 0x5555555555555555ULL);
+        word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+        word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return (int)((word * 0x0101010101010101ULL) >> 56);
+#endif
+    }
+}
+
+#endif // BITWORD_H
@@ -6,6 +6,8 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include <climits>
+#include <cstdio>
 #include <fstream>
 #include <string>
 #include <assert.h>
@@ -19,86 +21,152 @@
 class ConfigDecodingException : public std::exception {
         
     public:
-        const char* message;
+        std::string message;
 
         ConfigDecodingException(std::string message) {
-            this->message = message.c_str();
+            this->message = message;
         }
 
         virtual const char* what() const throw () {
-            return message;
+            return message.c_str();
         }
 };
 
+/**
+ * @brief The simulation parameters, read from the configuration file once.
+ * 
+ * The simulation reads these plain fields rather than looking parameters up by
+ * name in the JSON document, since several of them are read once per packet or
+ * per neuron.
+ */
+struct ConfigParameters {
+    int num_neurons;
+    int num_axons;
+    int num_cores_x;
+    int num_cores_y;
+    int num_weights;
+    int max_tick_offset;
+    int neuron_block_trace_verbosity;
+    int token_controller_trace_verbosity;
+    int scheduler_trace_verbosity;
+    // Bits of the membrane potential and of the weights and leak. Below 32 bits, potentials
+    // saturate at the limits of potential_width. At 32 bits, the default, they use plain int
+    // arithmetic.
+    int potential_width;
+    int parameter_width;
+    // The range of potential_width and parameter_width bits
+    int min_potential, max_potential;
+    int min_parameter, max_parameter;
+};
+
 class Config {
     public:
-        static rapidjson::Document parameters;
+        // Read-only view of the parameters loaded by setParameters
+        static const ConfigParameters& parameters;
 
         static void setParameters(std::string file_name) {
 
             FILE* fp = std::fopen(file_name.c_str(), "r");
+            if (fp == NULL) {
+                throw ConfigDecodingException("Could not open configuration file " + file_name + ".");
+            }
             // FIXME: Is this size going to matter?
             char readBuffer[65536];
             rapidjson::FileReadStream is(fp, readBuffer, sizeof(readBuffer));
             
-            if (parameters.ParseStream(is).HasParseError()) {
+            rapidjson::Document document;
+            bool parse_error = document.ParseStream(is).HasParseError();
+            std::fclose(fp);
+            if (parse_error) {
                 throw ConfigDecodingException("Could not parse input JSON");
             }
+
+            validateParameters(document);
+
+            loaded.num_neurons = document["num_neurons"].GetInt();
+            loaded.num_axons = document["num_axons"].GetInt();
+            loaded.num_cores_x = document["num_cores_x"].GetInt();
+            loaded.num_cores_y = document["num_cores_y"].GetInt();
+            loaded.num_weights = document["num_weights"].GetInt();
+            loaded.max_tick_offset = document["max_tick_offset"].GetInt();
+            loaded.neuron_block_trace_verbosity = document["neuron_block_trace_verbosity"].GetInt();
+            loaded.token_controller_trace_verbosity = document["token_controller_trace_verbosity"].GetInt();
+            loaded.scheduler_trace_verbosity = document["scheduler_trace_verbosity"].GetInt();
+            loaded.potential_width = document.HasMember("potential_width") ? document["potential_width"].GetInt() : 32;
+            loaded.parameter_width = document.HasMember("parameter_width") ? document["parameter_width"].GetInt() : loaded.potential_width;
+            if (loaded.parameter_width > loaded.potential_width) {
+                throw ConfigDecodingException("Configuration parameter parameter_width must be <= potential_width");
+            }
+            loaded.min_potential = minValue(loaded.potential_width);
+            loaded.max_potential = maxValue(loaded.potential_width);
+            loaded.min_parameter = minValue(loaded.parameter_width);
+            loaded.max_parameter = maxValue(loaded.parameter_width);
+        }
+
+        // Returns whether neuron state fits in 16-bit lanes
+        static bool narrowLanes() {
+            return parameters.potential_width <= 16;
         }
 
         static bool traceSpecified() {
-            return parameters["neuron_block_trace_verbosity"].GetInt() || parameters["token_controller_trace_verbosity"].GetInt() || parameters["scheduler_trace_verbosity"].GetInt();
+            return parameters.neuron_block_trace_verbosity || parameters.token_controller_trace_verbosity || parameters.scheduler_trace_verbosity;
         }
     private:
-        static void validateIntParameterMinMax(std::string name, int min_val, int max_val) {
-            if (!parameters.HasMember(name.c_str())) {
-                throw ConfigDecodingException("Configuration file does not have parameter " + name + ".");
-            }
-            if (!parameters[name.c_str()].IsInt()) {
-                throw ConfigDecodingException("Configuration parameter " + name + " could not be parsed as integer.");
-            }
-            if (parameters[name.c_str()].GetInt() < min_val) {
+        static ConfigParameters loaded;
+
+        // The range of a two's complement integer of `width` bits
+        static int minValue(int width) {
+            return width == 32 ? INT_MIN : -(1 << (width - 1));
+        }
+
+        static int maxValue(int width) {
+            return width == 32 ? INT_MAX : (1 << (width - 1)) - 1;
+        }
+
+        static void validateIntParameterMinMax(const rapidjson::Document& document, std::string name, int min_val, int max_val) {
+            validateIntParameterMin(document, name, min_val);
+            validateIntParameterMax(document, name, max_val);
+        }
+
+        static void validateIntParameterMin(const rapidjson::Document& document, std::string name, int min_val) {
+            validateIntParameter(document, name);
+            if (document[name.c_str()].GetInt() < min_val) {
                 throw ConfigDecodingException("Configuration parameter " + name + " must be >= " + std::to_string(min_val));
             }
-            if (parameters[name.c_str()].GetInt() > max_val) {
-                throw ConfigDecodingException("Configuration parameter " + name + " must be <= " + std::to_string(min_val));
-            }
         }
 
-        static void validateIntParameterMin(std::string name, int min_val) {
-            if (!parameters.HasMember(name.c_str())) {
-                throw ConfigDecodingException("Configuration file does not have parameter " + name + ".");
-            }
-            if (!parameters[name.c_str()].IsInt()) {
-                throw ConfigDecodingException("Configuration parameter " + name + " could not be parsed as integer.");
-            }
-            if (parameters[name.c_str()].GetInt() < min_val) {
-                throw ConfigDecodingException("Configuration parameter " + name + " must be >= " + std::to_string(min_val));
+        static void validateIntParameterMax(const rapidjson::Document& document, std::string name, int max_val) {
+            validateIntParameter(document, name);
+            if (document[name.c_str()].GetInt() > max_val) {
+                throw ConfigDecodingException("Configuration parameter " + name + " must be <= " + std::to_string(max_val));
             }
         }
 
-        static void validateIntParameterMax(std::string name, int min_val, int max_val) {
-            if (!parameters.HasMember(name.c_str())) {
+        static void validateIntParameter(const rapidjson::Document& document, std::string name) {
+            if (!document.IsObject() || !document.HasMember(name.c_str())) {
                 throw ConfigDecodingException("Configuration file does not have parameter " + name + ".");
             }
-            if (!parameters[name.c_str()].IsInt()) {
+            if (!document[name.c_str()].IsInt()) {
                 throw ConfigDecodingException("Configuration parameter " + name + " could not be parsed as integer.");
             }
-            if (parameters[name.c_str()].GetInt() > max_val) {
-                throw ConfigDecodingException("Configuration parameter " + name + " must be <= " + std::to_string(min_val));
-            }
         }
 
-        static void validateParameters() {
-            validateIntParameterMin("num_neurons", 0);
-            validateIntParameterMin("num_axons", 0);
-            validateIntParameterMin("num_cores_x", 0);
-            validateIntParameterMin("num_cores_y", 0);
-            validateIntParameterMin("num_weights", 0);
-            validateIntParameterMin("max_tick_offset", 0);
-            validateIntParameterMinMax("neuron_block_trace_verbosity", 0, 2);
-            validateIntParameterMinMax("token_controller_trace_verbosity", 0, 1);
-            validateIntParameterMinMax("scheduler_trace_verbosity", 0, 2);
+        static void validateParameters(const rapidjson::Document& document) {
+            validateIntParameterMin(document, "num_neurons", 1);
+            validateIntParameterMin(document, "num_axons", 1);
+            validateIntParameterMin(document, "num_cores_x", 1);
+            validateIntParameterMin(document, "num_cores_y", 1);
+            validateIntParameterMin(document, "num_weights", 1);
+            validateIntParameterMin(document, "max_tick_offset", 1);
+            validateIntParameterMinMax(document, "neuron_block_trace_verbosity", 0, 2);
+            validateIntParameterMinMax(document, "token_controller_trace_verbosity", 0, 1);
+            validateIntParameterMinMax(document, "scheduler_trace_verbosity", 0, 2);
+            if (document.HasMember("potential_width")) {
+                validateIntParameterMinMax(document, "potential_width", 2, 32);
+            }
+            if (document.HasMember("parameter_width")) {
+                validateIntParameterMinMax(document, "parameter_width", 2, 32);
+            }
         }
 };
 
@@ -14,13 +14,13 @@ Core::Core() {
 	this->router = new Router(this, NULL, NULL, NULL, NULL);
 	this->scheduler = new Scheduler(this);
 	this->neuron_block = new NeuronBlock();
-	this->csram = std::vector<CSRAMRow*>(Config::parameters["num_neurons"].GetInt(), new CSRAMRow());
-	this->token_controller = new TokenController(this, router, scheduler, neuron_block, csram, std::vector<int>(Config::parameters["num_axons"].GetInt()));
+	this->csram = new CSRAM();
+	this->token_controller = new TokenController(this, router, scheduler, neuron_block, csram, std::vector<int>(Config::parameters.num_axons));
 	this->x = 0;
 	this->y = 0;
 }
 
-Core::Core(Core *north, Core *south, Core *west, Core *east, std::vector<CSRAMRow*> csram, std::vector<int> neuron_instructions, int x, int y){
+Core::Core(Core *north, Core *south, Core *west, Core *east, CSRAM* csram, std::vector<int> neuron_instructions, int x, int y){
 	this->router = new Router(this, north != NULL ? north->router : NULL, south != NULL ? south->router : NULL, west != NULL ? west->router : NULL, east != NULL ? east->router : NULL);
 	this->scheduler = new Scheduler(this);
 	this->neuron_block = new NeuronBlock();
@@ -30,6 +30,15 @@ Core::Core(Core *north, Core *south, Core *west, Core *east, std::vector<CSRAMRo
 	this->y = y;
 }
 
+void Core::relocate() {
+	CSRAM* local_csram = new CSRAM(*csram);
+	delete csram;
+	csram = local_csram;
+	token_controller->csram = local_csram;
+	token_controller->relocate();
+	scheduler->relocate();
+}
+
 std::string Core::to_string() {
 	return "coordinates: (" + std::to_string(this->x) + "," + std::to_string(this->y) + ")";
 }
\ No newline at end of file
@@ -15,21 +15,24 @@ class TokenController;
 #include <vector>
 
 #include "packet.h"
-#include "csramrow.h"
+#include "csram.h"
 #include "neuronblock.h"
 
 class Core{
 	public:
 		Core();
-		Core(Core *north, Core *south, Core *west, Core *east, std::vector<CSRAMRow*> csram, std::vector<int> neuron_instructions, int x, int y);
+		Core(Core *north, Core *south, Core *west, Core *east, CSRAM* csram, std::vector<int> neuron_instructions, int x, int y);
 		
 		std::string to_string();
+		// Copies the core's state into memory allocated and first touched by the calling thread, which places
+		// it on that thread's NUMA node
+		void relocate();
 
 		// Core Components
 		Router *router;
 		Scheduler *scheduler;
 		NeuronBlock *neuron_block;
-		std::vector<CSRAMRow*> csram;
+		CSRAM* csram;
 		TokenController *token_controller;
 		
 		// Core Coordinates
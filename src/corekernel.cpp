@@ -0,0 +1,134 @@
+/// corekernel.cpp
+///
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#include <algorithm>
+
+#include "corekernel.h"
+#include "bitword.hpp"
+#include "neuronkernel.h"
+
+namespace CoreKernel {
+
+	// A dimension of 0 is read from the CSRAM at runtime.
+	template <int NUM_AXONS>
+	static int countSpikes(const CSRAM* csram, const uint64_t* spikes) {
+		const int num_words = NUM_AXONS ? BitWord::numWords(NUM_AXONS) : csram->num_axon_words;
+		int spike_count = 0;
+		for (int word = 0; word < num_words; word++) {
+			spike_count += BitWord::popcount(spikes[word]);
+		}
+		return spike_count;
+	}
+
+	// Same as NeuronBlock::integrateByType on every neuron, with the row strides fixed. A neuron whose
+	// potential could saturate part way through integrates its spikes one at a time in axon order.
+	template <int NUM_NEURONS, int NUM_AXONS, int NUM_WEIGHTS, typename Lane>
+	static void integrateNeuronMajor(CSRAM* csram, const uint64_t* spikes, const uint64_t* axon_type_masks, const int* neuron_instructions) {
+		const int num_neurons = NUM_NEURONS ? NUM_NEURONS : csram->num_neurons;
+		const int num_words = NUM_AXONS ? BitWord::numWords(NUM_AXONS) : csram->num_axon_words;
+		const int num_weights = NUM_WEIGHTS ? NUM_WEIGHTS : csram->num_weights;
+		Lane* current_potential = csram->current_potential.data<Lane>();
+		const int* weights = &csram->weights[0];
+		const uint64_t* connections = &csram->connections[0];
+
+		for (int neuron = 0; neuron < num_neurons; neuron++) {
+			const int* neuron_weights = &weights[neuron * num_weights];
+			const uint64_t* neuron_connections = &connections[neuron * num_words];
+			int potential = current_potential[neuron];
+			int64_t rising = 0, falling = 0;
+			for (int word = 0; word < num_words; word++) {
+				uint64_t active = neuron_connections[word] & spikes[word];
+				if (!active) {
+					continue;
+				}
+				for (int type = 0; type < num_weights; type++) {
+					int64_t input = (int64_t)neuron_weights[type] * BitWord::popcount(active & axon_type_masks[type * num_words + word]);
+					rising += input > 0 ? input : 0;
+					falling += input < 0 ? input : 0;
+				}
+			}
+
+			if (potential + rising <= csram->max_potential && potential + falling >= csram->min_potential) {
+				current_potential[neuron] = potential + rising + falling;
+				continue;
+			}
+			for (int word = 0; word < num_words; word++) {
+				uint64_t active = neuron_connections[word] & spikes[word];
+				while (active) {
+					int axon = word * BitWord::BITS_PER_WORD + BitWord::countTrailingZeros(active);
+					potential = std::min(std::max(potential + neuron_weights[neuron_instructions[axon]], csram->min_potential), csram->max_potential);
+					active &= active - 1;
+				}
+			}
+			current_potential[neuron] = potential;
+		}
+	}
+
+	template <int NUM_NEURONS, int NUM_AXONS, typename Lane>
+	static void integrateAxonMajor(CSRAM* csram, const uint64_t* spikes, const int* neuron_instructions) {
+		const int num_neurons = NUM_NEURONS ? NUM_NEURONS : csram->num_neurons;
+		const int num_words = NUM_AXONS ? BitWord::numWords(NUM_AXONS) : csram->num_axon_words;
+		const int num_neuron_words = BitWord::numWords(num_neurons);
+		Lane* current_potential = csram->current_potential.data<Lane>();
+		const Lane* type_weights = csram->type_weights.data<Lane>();
+
+		for (int word = 0; word < num_words; word++) {
+			uint64_t spiking_axons = spikes[word];
+			while (spiking_axons) {
+				int axon = word * BitWord::BITS_PER_WORD + BitWord::countTrailingZeros(spiking_axons);
+				NeuronKernel::addMaskedWeights<Lane, NUM_NEURONS>(num_neurons, current_potential, &type_weights[neuron_instructions[axon] * num_neurons], &csram->axon_connections[axon * num_neuron_words], csram->min_potential, csram->max_potential);
+				spiking_axons &= spiking_axons - 1;
+			}
+		}
+	}
+
+	template <int NUM_NEURONS, typename Lane>
+	static void leakAndFire(CSRAM* csram, uint64_t* fired) {
+		NeuronKernel::leakAndFire<Lane, NUM_NEURONS>(csram->num_neurons, csram->current_potential.data<Lane>(), csram->leak.data<Lane>(), csram->positive_threshold.data<Lane>(), csram->negative_threshold.data<Lane>(), csram->reset_potential.data<Lane>(), csram->reset_mode.data<Lane>(), csram->min_potential, csram->max_potential, fired);
+	}
+
+	template <int NUM_NEURONS, int NUM_AXONS, int NUM_WEIGHTS, typename Lane>
+	static Functions instantiate() {
+		Functions functions = {
+			countSpikes<NUM_AXONS>,
+			integrateNeuronMajor<NUM_NEURONS, NUM_AXONS, NUM_WEIGHTS, Lane>,
+			integrateAxonMajor<NUM_NEURONS, NUM_AXONS, Lane>,
+			leakAndFire<NUM_NEURONS, Lane>
+		};
+		return functions;
+	}
+
+	// Functions for 16-bit and 32-bit lanes
+	template <int NUM_NEURONS, int NUM_AXONS, int NUM_WEIGHTS>
+	static Functions instantiate(bool narrow) {
+		return narrow ? instantiate<NUM_NEURONS, NUM_AXONS, NUM_WEIGHTS, int16_t>() : instantiate<NUM_NEURONS, NUM_AXONS, NUM_WEIGHTS, int32_t>();
+	}
+
+	struct Geometry {
+		int num_neurons;
+		int num_axons;
+		int num_weights;
+		Functions (*functions)(bool narrow);
+	};
+
+	// Neuron counts used here must also be instantiated in neuronkernel.cpp
+	static const Geometry geometries[] = {
+		{256, 256, 4, instantiate<256, 256, 4>},
+		{512, 512, 4, instantiate<512, 512, 4>},
+		{128, 128, 4, instantiate<128, 128, 4>},
+		{64, 64, 4, instantiate<64, 64, 4>}
+	};
+
+	Functions forGeometry(const CSRAM* csram) {
+		bool narrow = csram->current_potential.isNarrow();
+		for (const Geometry& geometry : geometries) {
+			if (geometry.num_neurons == csram->num_neurons && geometry.num_axons == csram->num_axons && geometry.num_weights == csram->num_weights) {
+				return geometry.functions(narrow);
+			}
+		}
+		return instantiate<0, 0, 0>(narrow);
+	}
+}
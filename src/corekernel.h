@@ -0,0 +1,44 @@
+/// corekernel.h
+///
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#ifndef COREKERNEL_H
+#define COREKERNEL_H
+
+#include <cstdint>
+
+#include "csram.h"
+
+/**
+ * @brief The untraced work a token controller does on each tick, specialized for common core geometries.
+ *
+ * Every function is a template on the number of neurons, axons and weights of
+ * a core so that the crossbar and neuron loops have trip counts known at
+ * compile time, which lets the compiler unroll and vectorize them fully. The
+ * templates are instantiated for the standard 256/256/4 TrueNorth geometry and
+ * a few other sizes, and a token controller picks the instantiation matching
+ * its CSRAM when it is constructed. Any other geometry uses the generic
+ * instantiation, whose bounds are read from the CSRAM. Both give identical
+ * results. Each geometry is instantiated for both 16-bit and 32-bit neuron
+ * state lanes.
+ */
+namespace CoreKernel {
+
+	struct Functions {
+		// Number of spikes in the packed `spikes`
+		int (*count_spikes)(const CSRAM* csram, const uint64_t* spikes);
+		// Integrates `spikes` one neuron at a time, by popcounting each type of active connection
+		void (*integrate_neuron_major)(CSRAM* csram, const uint64_t* spikes, const uint64_t* axon_type_masks, const int* neuron_instructions);
+		// Integrates `spikes` one spiking axon at a time, down its column of the crossbar
+		void (*integrate_axon_major)(CSRAM* csram, const uint64_t* spikes, const int* neuron_instructions);
+		// Applies leak, thresholds and resets to every neuron, setting the bits of those that fire
+		void (*leak_and_fire)(CSRAM* csram, uint64_t* fired);
+	};
+
+	// Returns the functions for the geometry of `csram`, or the generic ones if it has no specialization.
+	Functions forGeometry(const CSRAM* csram);
+}
+
+#endif // COREKERNEL_H
@@ -0,0 +1,101 @@
+/// coreworklist.cpp
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#include <algorithm>
+
+#include "coreworklist.h"
+#include "scheduler.h"
+#include "tokencontroller.h"
+
+CoreWorklist::CoreWorklist(std::vector<Core*> cores, int num_cores_x) {
+	this->num_cores_x = num_cores_x;
+	this->tick = 0;
+	this->listed = std::vector<bool>(cores.size());
+
+	for (auto core : cores) {
+		// Cores of other processes are left out
+		if (core == NULL) {
+			continue;
+		}
+		core->scheduler->worklist = this;
+		if (core->token_controller->nextEventTick() != TokenController::NEVER) {
+			timers.push(std::make_pair(core->token_controller->nextEventTick(), core));
+		}
+	}
+}
+
+void CoreWorklist::beginTick(int tick) {
+	this->tick = tick;
+
+	bool woke_sleeping_core = false;
+	while (!timers.empty() && timers.top().first <= tick) {
+		Core* core = timers.top().second;
+		if (!listed[index(core)] && core->token_controller->nextEventTick() == timers.top().first) {
+			listed[index(core)] = true;
+			active_cores.push_back(core);
+			woke_sleeping_core = true;
+		}
+		timers.pop();
+	}
+	if (woke_sleeping_core) {
+		sortActiveCores();
+	}
+
+	for (auto core : active_cores) {
+		core->scheduler->updateCurrentWord(tick);
+	}
+}
+
+void CoreWorklist::wake(Core* core) {
+	if (listed[index(core)]) {
+		return;
+	}
+	listed[index(core)] = true;
+	core->scheduler->updateCurrentWord(tick);
+	woken_cores.push_back(core);
+}
+
+void CoreWorklist::endTick() {
+	std::vector<Core*> still_active;
+	for (auto core : active_cores) {
+		if (!isIdle(core)) {
+			still_active.push_back(core);
+			continue;
+		}
+		listed[index(core)] = false;
+		if (core->token_controller->nextEventTick() != TokenController::NEVER) {
+			timers.push(std::make_pair(core->token_controller->nextEventTick(), core));
+		}
+	}
+	active_cores.swap(still_active);
+
+	if (!woken_cores.empty()) {
+		active_cores.insert(active_cores.end(), woken_cores.begin(), woken_cores.end());
+		woken_cores.clear();
+		sortActiveCores();
+	}
+}
+
+// Listed cores have pending spikes or an event on the next tick, so only an empty list can skip ticks.
+// Stale timers are dropped here rather than in beginTick, which would ignore them anyway.
+int CoreWorklist::nextBusyTick(int tick) {
+	if (!active_cores.empty()) {
+		return tick;
+	}
+	while (!timers.empty() && timers.top().second->token_controller->nextEventTick() != timers.top().first) {
+		timers.pop();
+	}
+	return timers.empty() ? TokenController::NEVER : std::max(tick, timers.top().first);
+}
+
+// A core is idle when it has no pending spikes and nothing to do on the next tick.
+bool CoreWorklist::isIdle(Core* core) {
+	return !core->scheduler->hasPendingSpikes() && core->token_controller->nextEventTick() > tick + 1;
+}
+
+void CoreWorklist::sortActiveCores() {
+	std::sort(active_cores.begin(), active_cores.end(), [this](Core* a, Core* b) { return index(a) < index(b); });
+}
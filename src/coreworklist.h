@@ -0,0 +1,60 @@
+/// coreworklist.h
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#ifndef COREWORKLIST_H
+#define COREWORKLIST_H
+
+#include <vector>
+#include <queue>
+#include <utility>
+#include <functional>
+
+#include "core.h"
+
+/**
+ * @brief Tracks which cores can do anything on a tick.
+ * 
+ * A core is listed while its scheduler holds pending spikes or when one of its
+ * neurons will spike or reset from leak alone on the next tick. A core whose
+ * next such event is further away is put to sleep on a timer for that tick
+ * (see TokenController::nextEventTick). Cores that are not listed are skipped
+ * entirely, including advancing their scheduler, so their scheduler is brought
+ * up to the current tick when a spike wakes them up. Listed cores are kept in
+ * grid order so that output order does not change.
+ */
+class CoreWorklist {
+	public:
+		CoreWorklist(std::vector<Core*> cores, int num_cores_x);
+
+		// Advances the schedulers of all listed cores to `tick`.
+		void beginTick(int tick);
+		// Lists `core` if it is not already listed. Called before a spike is written to its scheduler.
+		void wake(Core* core);
+		// Drops cores that have gone idle and lists the cores woken during the tick.
+		void endTick();
+		// The first tick from `tick` on which a core can do anything without input, or TokenController::NEVER.
+		// Called between ticks, once the cores woken during the last tick have been listed.
+		int nextBusyTick(int tick);
+
+		// The cores listed at the start of the tick, in grid order.
+		const std::vector<Core*>& activeCores() { return active_cores; }
+
+	private:
+		int index(Core* core) { return core->x + core->y * num_cores_x; }
+		bool isIdle(Core* core);
+		void sortActiveCores();
+
+		int num_cores_x;
+		int tick;
+		std::vector<Core*> active_cores;
+		std::vector<Core*> woken_cores;
+		std::vector<bool> listed;
+		// (tick, core) pairs of sleeping cores, earliest first. Entries whose tick no longer
+		// matches the core's next event are stale and ignored.
+		std::priority_queue<std::pair<int, Core*>, std::vector<std::pair<int, Core*>>, std::greater<std::pair<int, Core*>>> timers;
+};
+
+#endif // COREWORKLIST_H
@@ -0,0 +1,143 @@
+/// csram.cpp
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#include <algorithm>
+#include <climits>
+#include <sstream>
+
+#include "csram.h"
+#include "bitword.hpp"
+#include "config.hpp"
+
+CSRAM::CSRAM() {
+	num_neurons = Config::parameters.num_neurons;
+	num_axons = Config::parameters.num_axons;
+	num_weights = Config::parameters.num_weights;
+	num_axon_words = BitWord::numWords(num_axons);
+	num_neuron_words = BitWord::numWords(num_neurons);
+	min_potential = Config::parameters.min_potential;
+	max_potential = Config::parameters.max_potential;
+
+	bool narrow = Config::narrowLanes();
+	current_potential = LaneVector(num_neurons, narrow);
+	reset_potential = LaneVector(num_neurons, narrow);
+	leak = LaneVector(num_neurons, narrow);
+	positive_threshold = LaneVector(num_neurons, narrow);
+	negative_threshold = LaneVector(num_neurons, narrow);
+	reset_mode = LaneVector(num_neurons, narrow);
+	dx = std::vector<int>(num_neurons);
+	dy = std::vector<int>(num_neurons);
+	destination_tick = std::vector<int>(num_neurons);
+	destination_axon = std::vector<int>(num_neurons);
+	weights = std::vector<int>(num_neurons * num_weights);
+	connections = std::vector<uint64_t>(num_neurons * num_axon_words);
+	axon_connections = std::vector<uint64_t>(num_axons * num_neuron_words);
+	type_weights = LaneVector(num_weights * num_neurons, narrow);
+
+	CSRAMRow default_row;
+	for (int neuron = 0; neuron < num_neurons; neuron++) {
+		setRow(neuron, default_row);
+	}
+}
+
+void CSRAM::setRow(int neuron, const CSRAMRow& row) {
+	current_potential.set(neuron, row.current_potential);
+	reset_potential.set(neuron, row.reset_potential);
+	leak.set(neuron, row.leak);
+	positive_threshold.set(neuron, row.positive_threshold);
+	negative_threshold.set(neuron, row.negative_threshold);
+	reset_mode.set(neuron, row.reset_mode);
+	dx[neuron] = row.dx;
+	dy[neuron] = row.dy;
+	destination_tick[neuron] = row.destination_tick;
+	destination_axon[neuron] = row.destination_axon;
+	std::copy(row.weights.begin(), row.weights.end(), weights.begin() + neuron * num_weights);
+	std::copy(row.connections.begin(), row.connections.end(), connections.begin() + neuron * num_axon_words);
+
+	for (int type = 0; type < num_weights; type++) {
+		type_weights.set(type * num_neurons + neuron, row.weights[type]);
+	}
+	uint64_t neuron_bit = (uint64_t)1 << (neuron % BitWord::BITS_PER_WORD);
+	for (int axon = 0; axon < num_axons; axon++) {
+		uint64_t& column_word = axon_connections[axon * num_neuron_words + neuron / BitWord::BITS_PER_WORD];
+		column_word = BitWord::test(&row.connections[0], axon) ? column_word | neuron_bit : column_word & ~neuron_bit;
+	}
+}
+
+CSRAMRow CSRAM::getRow(int neuron) {
+	return CSRAMRow(std::vector<uint64_t>(connectionRow(neuron), connectionRow(neuron) + num_axon_words), current_potential.get(neuron), reset_potential.get(neuron), leak.get(neuron), positive_threshold.get(neuron), negative_threshold.get(neuron), std::vector<int>(weightRow(neuron), weightRow(neuron) + num_weights), dx[neuron], dy[neuron], destination_tick[neuron], destination_axon[neuron], reset_mode.get(neuron));
+}
+
+bool CSRAM::canSpike(int neuron) const {
+	int potential = current_potential.get(neuron);
+	if (leak.get(neuron) != 0 || potential >= positive_threshold.get(neuron) || potential < negative_threshold.get(neuron)) {
+		return true;
+	}
+	const uint64_t* row = connectionRow(neuron);
+	bool connected = std::any_of(row, row + num_axon_words, [](uint64_t word) { return word != 0; });
+	return connected && std::any_of(weightRow(neuron), weightRow(neuron) + num_weights, [](int weight) { return weight != 0; });
+}
+
+// Returns the number of ticks without input until the first neuron spikes or resets, or INT_MAX if
+// no neuron ever will. Until then each tick only adds the leak: the potential stays between the
+// thresholds, which output_potential leaves unchanged. Since the thresholds lie within the
+// potential bounds, the potential cannot saturate before then either.
+int CSRAM::ticksUntilEvent() {
+	return current_potential.isNarrow() ? ticksUntilEvent<int16_t>() : ticksUntilEvent<int32_t>();
+}
+
+template <typename Lane>
+int CSRAM::ticksUntilEvent() {
+	const Lane* potentials = current_potential.data<Lane>();
+	const Lane* leaks = leak.data<Lane>();
+	const Lane* positive_thresholds = positive_threshold.data<Lane>();
+	const Lane* negative_thresholds = negative_threshold.data<Lane>();
+	int64_t ticks = INT_MAX;
+	for (int neuron = 0; neuron < num_neurons; neuron++) {
+		int64_t potential = potentials[neuron];
+		int64_t neuron_leak = leaks[neuron];
+		int64_t positive = positive_thresholds[neuron];
+		int64_t negative = negative_thresholds[neuron];
+		int64_t after_one_tick = potential + neuron_leak;
+		if (after_one_tick >= positive || after_one_tick < negative) {
+			return 1;
+		}
+		if (neuron_leak > 0) {
+			// First tick at which potential + ticks * leak >= positive_threshold
+			ticks = std::min(ticks, (positive - potential + neuron_leak - 1) / neuron_leak);
+		} else if (neuron_leak < 0) {
+			// First tick at which potential + ticks * leak < negative_threshold
+			ticks = std::min(ticks, (potential - negative) / -neuron_leak + 1);
+		}
+	}
+	return ticks;
+}
+
+// Advances every neuron by `ticks` ticks without input. `ticks` must be less than ticksUntilEvent().
+void CSRAM::applyLeak(int ticks) {
+	if (current_potential.isNarrow()) {
+		applyLeak<int16_t>(ticks);
+	} else {
+		applyLeak<int32_t>(ticks);
+	}
+}
+
+template <typename Lane>
+void CSRAM::applyLeak(int ticks) {
+	Lane* potentials = current_potential.data<Lane>();
+	const Lane* leaks = leak.data<Lane>();
+	for (int neuron = 0; neuron < num_neurons; neuron++) {
+		potentials[neuron] += (int64_t)ticks * leaks[neuron];
+	}
+}
+
+std::string CSRAM::to_string(bool hex) {
+	std::ostringstream s;
+	for (int neuron = 0; neuron < num_neurons; neuron++) {
+		s << "Neuron " << neuron << ": " << getRow(neuron).to_string(hex) << std::endl;
+	}
+	return s.str();
+}
@@ -0,0 +1,84 @@
+/// csram.h
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#ifndef CSRAM_H
+#define CSRAM_H
+
+#include <cstdint>
+#include <vector>
+#include <string>
+
+#include "csramrow.h"
+#include "lanevector.hpp"
+
+/**
+ * @brief The CSRAM of a core, holding the parameters of all of its neurons
+ * 
+ * Parameters are stored as a structure of arrays indexed by neuron so that the
+ * token controller can stream through one parameter at a time. The weights and
+ * connections of neuron `i` are the `i`th `num_weights` and `num_axon_words`
+ * sized blocks of `weights` and `connections`.
+ * 
+ * The crossbar and weights are also kept transposed for axon-major integration:
+ * `axon_connections` holds one packed neuron mask per axon and `type_weights`
+ * holds one weight per neuron for each axon type.
+ * 
+ * The neuron state that the vector kernels stream through is kept in
+ * LaneVectors, which use 16-bit lanes when the configured potential width
+ * allows it.
+ */
+class CSRAM {
+	public:
+		// Creates a CSRAM where every row is a default CSRAMRow
+		CSRAM();
+
+		void setRow(int neuron, const CSRAMRow& row);
+		CSRAMRow getRow(int neuron);
+
+		const int* weightRow(int neuron) const { return &weights[neuron * num_weights]; }
+		const uint64_t* connectionRow(int neuron) const { return &connections[neuron * num_axon_words]; }
+		const uint64_t* axonColumn(int axon) const { return &axon_connections[axon * num_neuron_words]; }
+
+		int ticksUntilEvent();
+		void applyLeak(int ticks);
+		// Whether `neuron` can ever spike. Without leak, weighted connections or a potential outside
+		// its thresholds it never leaves its potential, which is how unconfigured rows are left.
+		bool canSpike(int neuron) const;
+
+		std::string to_string(bool hex);
+
+		int num_neurons;
+		int num_axons;
+		int num_weights;
+		int num_axon_words;
+		int num_neuron_words;
+		// Potentials saturate at these bounds
+		int min_potential;
+		int max_potential;
+
+		LaneVector current_potential;
+		LaneVector reset_potential;
+		LaneVector leak;
+		LaneVector positive_threshold;
+		LaneVector negative_threshold;
+		LaneVector reset_mode;
+		std::vector<int> dx, dy;
+		std::vector<int> destination_tick;
+		std::vector<int> destination_axon;
+		std::vector<int> weights;
+		std::vector<uint64_t> connections;
+		std::vector<uint64_t> axon_connections;
+		LaneVector type_weights;
+
+	private:
+		// Versions of the above for the lane type of the neuron state
+		template <typename Lane>
+		int ticksUntilEvent();
+		template <typename Lane>
+		void applyLeak(int ticks);
+};
+
+#endif // CSRAM_H
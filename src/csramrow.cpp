@@ -4,19 +4,21 @@
 ///
 ///
 
+#include <algorithm>
 #include <sstream>
 
 #include "csramrow.h"
+#include "bitword.hpp"
 #include "config.hpp"
 
 CSRAMRow::CSRAMRow() {
-	this->connections = std::vector<bool>(Config::parameters["num_axons"].GetInt());
+	this->connections = std::vector<uint64_t>(BitWord::numWords(Config::parameters.num_axons));
 	this->current_potential = 0;
 	this->reset_potential = 0;
 	this->leak = 0;
 	this->positive_threshold = 1;
 	this->negative_threshold = 0;
-	this->weights = std::vector<int>(Config::parameters["num_weights"].GetInt());;
+	this->weights = std::vector<int>(Config::parameters.num_weights);;
 	this->dx = 0;
 	this->dy = 0;
 	this->destination_tick = 0;
@@ -24,7 +26,7 @@ CSRAMRow::CSRAMRow() {
 	this->reset_mode = 0;
 }
 
-CSRAMRow::CSRAMRow(std::vector<bool> connections, int current_potential, int reset_potential, int leak, int positive_threshold, int negative_threshold, std::vector<int> weights, int dx, int dy, int destination_tick, int destination_axon, int reset_mode) {
+CSRAMRow::CSRAMRow(std::vector<uint64_t> connections, int current_potential, int reset_potential, int leak, int positive_threshold, int negative_threshold, std::vector<int> weights, int dx, int dy, int destination_tick, int destination_axon, int reset_mode) {
 	this->connections = connections;
 	this->current_potential = current_potential;
 	this->reset_potential = reset_potential;
@@ -39,6 +41,14 @@ CSRAMRow::CSRAMRow(std::vector<bool> connections, int current_potential, int res
 	this->reset_mode = reset_mode;
 }
 
+bool CSRAMRow::canSpike() const {
+	if (leak != 0 || current_potential >= positive_threshold || current_potential < negative_threshold) {
+		return true;
+	}
+	bool connected = std::any_of(connections.begin(), connections.end(), [](uint64_t word) { return word != 0; });
+	return connected && std::any_of(weights.begin(), weights.end(), [](int weight) { return weight != 0; });
+}
+
 std::string CSRAMRow::to_string(bool hex) {
 	std::ostringstream s;
 	// TODO: Implement hex to_string
@@ -46,8 +56,8 @@ std::string CSRAMRow::to_string(bool hex) {
 		s << "[WARNING] CSRAMRow to_string hex not implemented.";
 	} else {
 		s << "connections: [";
-		for (auto connection : connections) {
-			s << connection;
+		for (int i = 0; i < Config::parameters.num_axons; i++) {
+			s << BitWord::test(&connections[0], i);
 		}
 		s << "], current potential: " << current_potential;
 		s << ", reset potential: " << reset_potential;
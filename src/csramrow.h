@@ -7,6 +7,7 @@
 #ifndef CSRAMROW_H
 #define CSRAMROW_H
 
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -14,7 +15,7 @@
  * @brief A single CSRAM Row corresponding to one neuron
  * 
  * Holds all parameters for one neuron. Current parameters are:
- * 	- connections
+ * 	- connections (packed 64 axons per word, see bitword.hpp)
  * 	- current_potential
  * 	- reset_potential
  * 	- leak
@@ -26,11 +27,13 @@ class CSRAMRow {
 	public:
 		CSRAMRow();
 		
-		CSRAMRow(std::vector<bool> connections, int current_potential, int reset_potential, int leak, int positive_threshold, int negative_threshold, std::vector<int> weights, int dx, int dy, int destination_tick, int destination_axon, int reset_mode);
+		CSRAMRow(std::vector<uint64_t> connections, int current_potential, int reset_potential, int leak, int positive_threshold, int negative_threshold, std::vector<int> weights, int dx, int dy, int destination_tick, int destination_axon, int reset_mode);
 
 		std::string to_string(bool hex);
+		// Whether the neuron can ever spike, see CSRAM::canSpike
+		bool canSpike() const;
 
-		std::vector<bool> connections;
+		std::vector<uint64_t> connections;
         int current_potential;
 		int reset_potential;
 		int leak;
@@ -15,7 +15,9 @@
 #include <rapidjson/filereadstream.h>
 
 #include "config.hpp"
+#include "bitword.hpp"
 #include "csramrow.h"
+#include "csram.h"
 #include "tokencontroller.h"
 #include "packet.h"
 #include "core.h"
@@ -25,14 +27,178 @@ namespace Decode {
     class InputDecodingException : public std::exception {
         
         public:
-            const char* message;
+            std::string message;
 
             InputDecodingException(std::string message) {
-                this->message = message.c_str();
+                this->message = message;
             }
 
             virtual const char* what() const throw () {
-                return message;
+                return message.c_str();
+            }
+    };
+    
+    /**
+     * @brief Reads the elements of one array of the input file one at a time.
+     * 
+     * The input file is tokenized as it is read, and each element of the
+     * root object's `array_name` array is built into a document of its own
+     * and handed to the visitor. So only one element is held in memory at a
+     * time, however large the network is. The rest of the file is only
+     * checked for syntax.
+     */
+    class ArrayStream {
+        public:
+            ArrayStream(std::string file_name, std::string array_name) {
+                this->file_name = file_name;
+                this->array_name = array_name;
+                this->element = NULL;
+                this->depth = 0;
+                this->after_root_key = false;
+                this->root_value = false;
+                this->started_array = false;
+                this->ended_array = false;
+            }
+
+            // Calls `visit` with each element and its index. Throws `not_array_message` if the root object has
+            // no such array.
+            template <typename Visitor>
+            void forEach(Visitor visit, std::string not_array_message) {
+                FILE* fp = std::fopen(file_name.c_str(), "r");
+                if (fp == NULL) {
+                    throw InputDecodingException("Could not open input file " + file_name + ".");
+                }
+                char readBuffer[65536];
+                rapidjson::FileReadStream is(fp, readBuffer, sizeof(readBuffer));
+                rapidjson::Reader reader;
+                reader.IterativeParseInit();
+                bool found = false;
+
+                try {
+                    while (next(reader, is)) {
+                        if (!root_value || root_key != array_name || found) {
+                            continue;
+                        }
+                        if (!started_array) {
+                            throw InputDecodingException(not_array_message);
+                        }
+                        found = true;
+                        for (int index = 0; readElement(reader, is); index++) {
+                            visit(document, index);
+                        }
+                    }
+                } catch (...) {
+                    std::fclose(fp);
+                    throw;
+                }
+                std::fclose(fp);
+
+                if (!found) {
+                    throw InputDecodingException(not_array_message);
+                }
+            }
+
+            // SAX events. Those inside the current element are passed on to its document.
+            bool Null() { value(); return element == NULL || element->Null(); }
+            bool Bool(bool b) { value(); return element == NULL || element->Bool(b); }
+            bool Int(int i) { value(); return element == NULL || element->Int(i); }
+            bool Uint(unsigned i) { value(); return element == NULL || element->Uint(i); }
+            bool Int64(int64_t i) { value(); return element == NULL || element->Int64(i); }
+            bool Uint64(uint64_t i) { value(); return element == NULL || element->Uint64(i); }
+            bool Double(double d) { value(); return element == NULL || element->Double(d); }
+            bool RawNumber(const char* str, rapidjson::SizeType length, bool copy) { value(); return element == NULL || element->RawNumber(str, length, copy); }
+            bool String(const char* str, rapidjson::SizeType length, bool copy) { value(); return element == NULL || element->String(str, length, copy); }
+            bool Key(const char* str, rapidjson::SizeType length, bool copy) {
+                root_value = false;
+                if (depth == 1) {
+                    root_key = std::string(str, length);
+                    after_root_key = true;
+                }
+                return element == NULL || element->Key(str, length, copy);
+            }
+            bool StartObject() {
+                value();
+                depth++;
+                return element == NULL || element->StartObject();
+            }
+            bool EndObject(rapidjson::SizeType count) {
+                value();
+                depth--;
+                return element == NULL || element->EndObject(count);
+            }
+            bool StartArray() {
+                value();
+                started_array = true;
+                depth++;
+                return element == NULL || element->StartArray();
+            }
+            bool EndArray(rapidjson::SizeType count) {
+                value();
+                depth--;
+                // The end of the streamed array itself is not part of any element
+                if (depth == 1 && element != NULL) {
+                    ended_array = true;
+                    return true;
+                }
+                return element == NULL || element->EndArray(count);
+            }
+
+        private:
+            std::string file_name;
+            std::string array_name;
+            // The element read last, and the document events are passed on to while it is being read
+            rapidjson::Document document;
+            rapidjson::Document* element;
+            // Number of objects and arrays the last event is inside, counting one it started
+            int depth;
+            // The last key of the root object, and whether the last event was the first of its value
+            std::string root_key;
+            bool after_root_key;
+            bool root_value;
+            // Whether the last event started an array, or ended the streamed array
+            bool started_array;
+            bool ended_array;
+
+            void value() {
+                root_value = after_root_key;
+                after_root_key = false;
+                started_array = false;
+            }
+
+            // Reads the next event, returning false once the whole file has been read
+            template <typename InputStream>
+            bool next(rapidjson::Reader& reader, InputStream& is) {
+                if (reader.IterativeParseComplete()) {
+                    return false;
+                }
+                if (!reader.IterativeParseNext<rapidjson::kParseDefaultFlags>(is, *this)) {
+                    throw InputDecodingException("Could not parse input JSON");
+                }
+                return true;
+            }
+
+            // Reads the next element of the streamed array into `document`, returning false at the end of the array
+            template <typename InputStream>
+            bool readElement(rapidjson::Reader& reader, InputStream& is) {
+                // The first event either starts the element or ends the array. Populate keeps it, since it
+                // only clears the document's stack once the element is complete.
+                rapidjson::Document().Swap(document);
+                element = &document;
+                ended_array = false;
+                next(reader, is);
+                if (ended_array) {
+                    element = NULL;
+                    return false;
+                }
+                auto finish = [this, &reader, &is](rapidjson::Document&) {
+                    while (depth > 2) {
+                        next(reader, is);
+                    }
+                    element = NULL;
+                    return true;
+                };
+                document.Populate(finish);
+                return true;
             }
     };
     
@@ -49,7 +215,7 @@ namespace Decode {
         if (!(*itr)["destination_core"][0].IsInt() || !(*itr)["destination_core"][1].IsInt()) {
             throw InputDecodingException("Packet destination_core array value is not an integer.");
         }
-        if ((*itr)["destination_core"][0].GetInt() >= Config::parameters["num_cores_x"].GetInt() || (*itr)["destination_core"][1].GetInt() >= Config::parameters["num_cores_y"].GetInt()) {
+        if ((*itr)["destination_core"][0].GetInt() < 0 || (*itr)["destination_core"][1].GetInt() < 0 || (*itr)["destination_core"][0].GetInt() >= Config::parameters.num_cores_x || (*itr)["destination_core"][1].GetInt() >= Config::parameters.num_cores_y) {
             throw InputDecodingException("Packet destination_core is out of range of num_cores_x or num_cores_y.");
         }
         return std::vector<int>{(*itr)["destination_core"][0].GetInt(), (*itr)["destination_core"][1].GetInt()};
@@ -62,8 +228,8 @@ namespace Decode {
         if (!(*itr)["destination_axon"].IsInt()) {
             throw InputDecodingException("Packet destination_axon object could not be parsed as an integer.");
         }
-        if ((*itr)["destination_axon"].GetInt() >= Config::parameters["num_axons"].GetInt()) {
-            throw InputDecodingException("Packet destination_axon is >= num_axons.");
+        if ((*itr)["destination_axon"].GetInt() < 0 || (*itr)["destination_axon"].GetInt() >= Config::parameters.num_axons) {
+            throw InputDecodingException("Packet destination_axon is negative or >= num_axons.");
         }
         return(*itr)["destination_axon"].GetInt();
     }
@@ -75,39 +241,26 @@ namespace Decode {
         if (!(*itr)["destination_tick"].IsInt()) {
             throw InputDecodingException("Packet destination_tick object could not be parsed as an integer.");
         }
-        if ((*itr)["destination_tick"].GetInt() >= Config::parameters["max_tick_offset"].GetInt()) {
-            throw InputDecodingException("Packet destination_tick is >= max_tick_offset.");
+        if ((*itr)["destination_tick"].GetInt() < 0 || (*itr)["destination_tick"].GetInt() >= Config::parameters.max_tick_offset) {
+            throw InputDecodingException("Packet destination_tick is negative or >= max_tick_offset.");
         }
         return(*itr)["destination_tick"].GetInt();
     }
     
     std::vector<std::vector<Packet*>> parseInputPackets(std::string file_name, int num_ticks) {
-        // FIXME: Input packets should probably be parsed tick by tick to save memory?
         std::vector<std::vector<Packet*>> packets(num_ticks);
         
-        FILE* fp = std::fopen(file_name.c_str(), "r");
-        // FIXME: Is this size going to matter?
-        char readBuffer[65536];
-        rapidjson::FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-        
-        rapidjson::Document document;
-        
-        if (document.ParseStream(is).HasParseError()) {
-            throw InputDecodingException("Could not parse input JSON");
-        }
-        
-        const rapidjson::Value& packets_json = document["packets"];
-        
-        if (!packets_json.IsArray()) {
-            throw InputDecodingException("Packet json could not be parsed as an array object.");
-        }
-        
-        for (rapidjson::Value::ConstValueIterator tick_itr = packets_json.Begin(); tick_itr != packets_json.End(); tick_itr++) {
-            if (!tick_itr->IsArray()) {
+        // Each tick's packets are read on their own
+        ArrayStream stream(file_name, "packets");
+        stream.forEach([&packets, num_ticks](const rapidjson::Value& tick_json, int tick) {
+            if (tick >= num_ticks) {
+                return;
+            }
+            if (!tick_json.IsArray()) {
                 throw InputDecodingException("Inner array of packet json could not be parsed as an array object.");
             }
             std::vector<Packet*> temp;
-            for (rapidjson::Value::ConstValueIterator packet_itr = tick_itr->Begin(); packet_itr != tick_itr->End(); packet_itr++) {
+            for (rapidjson::Value::ConstValueIterator packet_itr = tick_json.Begin(); packet_itr != tick_json.End(); packet_itr++) {
                 std::vector<int> destination_core = parsePacketDestinationCore(packet_itr);
                 int destination_tick = parsePacketDestinationTick(packet_itr);
                 int destination_axon = parsePacketDestinationAxon(packet_itr);
@@ -115,11 +268,8 @@ namespace Decode {
                 temp.push_back(new Packet(destination_core[0], destination_core[1], destination_tick, destination_axon));
             }
             
-            packets[tick_itr - packets_json.Begin()] = temp;
-            if (tick_itr - packets_json.Begin() == num_ticks) {
-                break;
-            }
-        }
+            packets[tick] = temp;
+        }, "Packet json could not be parsed as an array object.");
         
         return packets;
     }
@@ -137,7 +287,7 @@ namespace Decode {
         if (!(*itr)["coordinates"][0].IsInt() || !(*itr)["coordinates"][1].IsInt()) {
             throw InputDecodingException("Core coordinates array value is not an integer.");
         }
-        if ((*itr)["coordinates"][0].GetInt() >= Config::parameters["num_cores_x"].GetInt() || (*itr)["coordinates"][1].GetInt() >= Config::parameters["num_cores_y"].GetInt()) {
+        if ((*itr)["coordinates"][0].GetInt() >= Config::parameters.num_cores_x || (*itr)["coordinates"][1].GetInt() >= Config::parameters.num_cores_y) {
             throw InputDecodingException("Core coordinates (" + std::to_string((*itr)["coordinates"][0].GetInt()) + ", " + std::to_string((*itr)["coordinates"][1].GetInt()) + ") is out of range of num_cores_x or num_cores_y.");
         }
         return std::vector<int>{(*itr)["coordinates"][0].GetInt(), (*itr)["coordinates"][1].GetInt()};
@@ -150,7 +300,7 @@ namespace Decode {
         if (!(*itr)["neurons"].IsArray()) {
             throw InputDecodingException("Core neurons object could not be parsed as an array.");
         }
-        if ((*itr)["neurons"].Size() > Config::parameters["num_neurons"].GetInt()) {
+        if ((*itr)["neurons"].Size() > Config::parameters.num_neurons) {
             throw InputDecodingException("Size of core neurons array is >= num_neurons.");
         }
         return (*itr)["neurons"];
@@ -163,13 +313,13 @@ namespace Decode {
         if (!(*itr)["connections"].IsArray()) {
             throw InputDecodingException("Neuron connections object could not be parsed as an array.");
         }
-        if ((*itr)["connections"].Size() > Config::parameters["num_axons"].GetInt()) {
+        if ((*itr)["connections"].Size() > Config::parameters.num_axons) {
             throw InputDecodingException("Neuron connections array size [" + std::to_string((*itr)["connections"].Size()) + "] is >= num_axons.");
         }
     }
     
     std::vector<int> parseCoreNeuronInstructions(rapidjson::Value::ConstValueIterator itr) {
-        std::vector<int> neuron_instructions(Config::parameters["num_axons"].GetInt());
+        std::vector<int> neuron_instructions(Config::parameters.num_axons);
         
         if (!itr->HasMember("axons")) {
             throw InputDecodingException("Core object does not have an axons member.");
@@ -179,14 +329,14 @@ namespace Decode {
             throw InputDecodingException("Core object axons member cannot be parsed as an array.");
         }
         
-        if ((*itr)["axons"].Size() > Config::parameters["num_axons"].GetInt()) {
+        if ((*itr)["axons"].Size() > Config::parameters.num_axons) {
             throw InputDecodingException("Axons array for core (" + std::to_string((*itr)["coordinates"][0].GetInt()) + ", " + std::to_string((*itr)["coordinates"][1].GetInt()) + ") is >= num_axons");
         }
         for (rapidjson::Value::ConstValueIterator inst_itr = (*itr)["axons"].Begin(); inst_itr != (*itr)["axons"].End(); inst_itr++) {
             if (!(*inst_itr).IsInt()) {
                 throw InputDecodingException("Could not parse neuron isntruction as integer.");
             }
-            if ((*inst_itr).GetInt() >= Config::parameters["num_weights"].GetInt() || (*inst_itr).GetInt() < 0) {
+            if ((*inst_itr).GetInt() >= Config::parameters.num_weights || (*inst_itr).GetInt() < 0) {
                 throw InputDecodingException("Neuron instruction is not within the range of num_weights");
             }
             neuron_instructions[inst_itr - (*itr)["axons"].Begin()] = (*inst_itr).GetInt();
@@ -195,17 +345,19 @@ namespace Decode {
         return neuron_instructions;
     }
     
-    std::vector<bool> parseNeuronConnections(rapidjson::Value::ConstValueIterator itr, int neuron_num) {
-        std::vector<bool> connections(Config::parameters["num_axons"].GetInt());
+    std::vector<uint64_t> parseNeuronConnections(rapidjson::Value::ConstValueIterator itr, int neuron_num) {
+        std::vector<uint64_t> connections(BitWord::numWords(Config::parameters.num_axons));
         
-        if ((*itr)["connections"][neuron_num].Size() > Config::parameters["num_axons"].GetInt()) {
+        if ((*itr)["connections"][neuron_num].Size() > Config::parameters.num_axons) {
             throw InputDecodingException("Connections array for neuron " + std::to_string(neuron_num) + " [" + std::to_string((*itr)["connections"][neuron_num].Size()) + "] is >= num_axons");
         }
         for (int i = 0; i < (*itr)["connections"][neuron_num].Size(); i++) {
             if (!(*itr)["connections"][neuron_num][i].IsInt() || (*itr)["connections"][neuron_num][i].GetInt() > 1 || (*itr)["connections"][neuron_num][i].GetInt() < 0) {
                 throw InputDecodingException("Could not parse connections value as a boolean");
             }
-            connections[i] = (*itr)["connections"][neuron_num][i].GetInt();
+            if ((*itr)["connections"][neuron_num][i].GetInt()) {
+                BitWord::set(&connections[0], i);
+            }
         }
         
         return connections;
@@ -218,15 +370,18 @@ namespace Decode {
         if (!(*itr)["weights"].IsArray()) {
             throw InputDecodingException("Neuron weights object could not be parsed as an array.");
         }
-        if ((*itr)["weights"].Size() > Config::parameters["num_weights"].GetInt()) {
+        if ((*itr)["weights"].Size() > Config::parameters.num_weights) {
             throw InputDecodingException("Neuron weights array size [" + std::to_string((*itr)["weights"].Size()) + "] is >= num_weights.");
         }
         
-        std::vector<int> weights(Config::parameters["num_weights"].GetInt());
+        std::vector<int> weights(Config::parameters.num_weights);
         for (rapidjson::Value::ConstValueIterator weight_itr = (*itr)["weights"].Begin(); weight_itr != (*itr)["weights"].End(); weight_itr++) {
             if (!weight_itr->IsInt()) {
                 throw InputDecodingException("Neuron weights array value cannot be parsed as an integer.");
             }
+            if (weight_itr->GetInt() < Config::parameters.min_parameter || weight_itr->GetInt() > Config::parameters.max_parameter) {
+                throw InputDecodingException("Neuron weight of " + std::to_string(weight_itr->GetInt()) + " does not fit in parameter_width bits.");
+            }
             weights[weight_itr - (*itr)["weights"].Begin()] = weight_itr->GetInt();
         }
 	
@@ -246,8 +401,11 @@ namespace Decode {
         if (!(*itr)["destination_core"][0].IsInt() || !(*itr)["destination_core"][1].IsInt()) {
             throw InputDecodingException("Neuron destination_core array value is not an integer.");
         }
-        if ((*itr)["destination_core"][0].GetInt() + x >= Config::parameters["num_cores_x"].GetInt() || (*itr)["destination_core"][1].GetInt() +y >= Config::parameters["num_cores_y"].GetInt()) {
-            throw InputDecodingException("Neuron destination_core is out of range of num_cores_x or num_cores_y.");
+        // Destinations are offsets from the core (`x`, `y`) and must land on the grid
+        int destination_x = (*itr)["destination_core"][0].GetInt() + x;
+        int destination_y = (*itr)["destination_core"][1].GetInt() + y;
+        if (destination_x < 0 || destination_y < 0 || destination_x >= Config::parameters.num_cores_x || destination_y >= Config::parameters.num_cores_y) {
+            throw InputDecodingException("Neuron destination_core of core (" + std::to_string(x) + ", " + std::to_string(y) + ") leads to (" + std::to_string(destination_x) + ", " + std::to_string(destination_y) + "), which is out of range of num_cores_x or num_cores_y.");
         }
         return std::vector<int>{(*itr)["destination_core"][0].GetInt(), (*itr)["destination_core"][1].GetInt()};
     }
@@ -259,8 +417,8 @@ namespace Decode {
         if (!(*itr)["destination_axon"].IsInt()) {
             throw InputDecodingException("Neuron destination_axon object could not be parsed as an integer.");
         }
-        if ((*itr)["destination_axon"].GetInt() >= Config::parameters["num_axons"].GetInt()) {
-            throw InputDecodingException("Neuron destination_axon is >= num_axons.");
+        if ((*itr)["destination_axon"].GetInt() < 0 || (*itr)["destination_axon"].GetInt() >= Config::parameters.num_axons) {
+            throw InputDecodingException("Neuron destination_axon is negative or >= num_axons.");
         }
         return(*itr)["destination_axon"].GetInt();
     }
@@ -272,8 +430,8 @@ namespace Decode {
         if (!(*itr)["destination_tick"].IsInt()) {
             throw InputDecodingException("Neuron destination_tick object could not be parsed as an integer.");
         }
-        if ((*itr)["destination_tick"].GetInt() >= Config::parameters["max_tick_offset"].GetInt()) {
-            throw InputDecodingException("Neuron destination_tick is >= max_tick_offset.");
+        if ((*itr)["destination_tick"].GetInt() < 0 || (*itr)["destination_tick"].GetInt() >= Config::parameters.max_tick_offset) {
+            throw InputDecodingException("Neuron destination_tick is negative or >= max_tick_offset.");
         }
         return(*itr)["destination_tick"].GetInt();
     }
@@ -288,62 +446,91 @@ namespace Decode {
         return (*itr)[name.c_str()].GetInt();
     }
 
-    std::vector<Core*> parseCores(std::string file_name) {
-        int num_cores_x = Config::parameters["num_cores_x"].GetInt();
-        int num_cores_y = Config::parameters["num_cores_y"].GetInt();
-
-        std::vector<Core*> cores(num_cores_x*num_cores_y);
-        std::vector<int> coordinates(2);
-        
-        for (int i = 0; i < num_cores_x*num_cores_y; i++) {
-            cores[i] = new Core();
-        }
-        
-        FILE* fp = std::fopen(file_name.c_str(), "r");
-        // FIXME: Is this size going to matter?
-        char readBuffer[65536];
-        rapidjson::FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-        
-        rapidjson::Document document;
-        
-        if (document.ParseStream(is).HasParseError()) {
-            throw InputDecodingException("Could not parse input JSON");
+    // Parses a neuron parameter that must fit in the `width_name` configuration parameter's bits
+    int parseNeuronParameter(rapidjson::Value::ConstValueIterator itr, std::string name, int min_val, int max_val, std::string width_name) {
+        int value = parseNeuronParameter(itr, name);
+        if (value < min_val || value > max_val) {
+            throw InputDecodingException("Neuron " + name + " of " + std::to_string(value) + " does not fit in " + width_name + " bits.");
         }
-        
-        const rapidjson::Value& cores_json = document["cores"];
-        
-        if (!cores_json.IsArray()) {
-            throw InputDecodingException("Packet json could not be parsed as an array object.");
+        return value;
+    }
+
+    int parseNeuronPotential(rapidjson::Value::ConstValueIterator itr, std::string name) {
+        return parseNeuronParameter(itr, name, Config::parameters.min_potential, Config::parameters.max_potential, "potential_width");
+    }
+
+    int parseNeuronResetMode(rapidjson::Value::ConstValueIterator itr) {
+        int reset_mode = parseNeuronParameter(itr, "reset_mode");
+        if (reset_mode < 0 || reset_mode > 1) {
+            throw InputDecodingException("Neuron reset_mode of " + std::to_string(reset_mode) + " is out of range of acceptable reset modes.");
         }
+        return reset_mode;
+    }
+
+    // Parses neuron `neuron` of the core at (`x`, `y`) into a CSRAM row
+    CSRAMRow parseNeuron(rapidjson::Value::ConstValueIterator core_itr, rapidjson::Value::ConstValueIterator neuron_itr, int neuron, int x, int y) {
+        std::vector<uint64_t> connections = parseNeuronConnections(core_itr, neuron);
+        std::vector<int> weights(Config::parameters.num_weights);
+        weights = parseNeuronWeights(neuron_itr); 
+        std::vector<int> destination_core = parseNeuronDestinationCore(neuron_itr, x, y);
+        int destination_axon = parseNeuronDestinationAxon(neuron_itr);
+        int destination_tick = parseNeuronDestinationTick(neuron_itr);
+        return CSRAMRow(connections, parseNeuronPotential(neuron_itr, "current_potential"), parseNeuronPotential(neuron_itr, "reset_potential"), parseNeuronParameter(neuron_itr, "leak", Config::parameters.min_parameter, Config::parameters.max_parameter, "parameter_width"), parseNeuronPotential(neuron_itr, "positive_threshold"), parseNeuronPotential(neuron_itr, "negative_threshold"), weights, destination_core[0], destination_core[1], destination_tick, destination_axon, parseNeuronResetMode(neuron_itr));
+    }
+
+    // Builds the cores in rows `first_row` up to `end_row`, which are read one at a time. The cores of other
+    // rows are left out as NULL, and their neurons are only read to count the fan-in of the cores that are
+    // built.
+    std::vector<Core*> parseCores(std::string file_name, int first_row, int end_row) {
+        int num_cores_x = Config::parameters.num_cores_x;
+        int num_cores_y = Config::parameters.num_cores_y;
+
+        std::vector<Core*> cores(num_cores_x*num_cores_y, NULL);
+        std::vector<int> remote_fan_in(num_cores_x*num_cores_y);
+        std::vector<int> coordinates(2);
         
         // Parse cores
-        for (rapidjson::Value::ConstValueIterator core_itr = cores_json.Begin(); core_itr != cores_json.End(); core_itr++) {
+        ArrayStream stream(file_name, "cores");
+        stream.forEach([&](const rapidjson::Value& core_json, int) {
+            rapidjson::Value::ConstValueIterator core_itr = &core_json;
             coordinates = parseCoreCoordinates(core_itr);
-            std::vector<CSRAMRow*> csram(Config::parameters["num_neurons"].GetInt(), new CSRAMRow());
             const rapidjson::Value& neurons = parseCoreNeurons(core_itr);
             
             // Ensure connections are correct
             parseCoreConnections(core_itr);
             
+            if (coordinates[1] < first_row || coordinates[1] >= end_row) {
+                for (rapidjson::Value::ConstValueIterator neuron_itr = neurons.Begin(); neuron_itr != neurons.End(); neuron_itr++) {
+                    CSRAMRow row = parseNeuron(core_itr, neuron_itr, neuron_itr - neurons.Begin(), coordinates[0], coordinates[1]);
+                    int destination_y = coordinates[1] + row.dy;
+                    if (destination_y >= first_row && destination_y < end_row && row.canSpike()) {
+                        remote_fan_in[coordinates[0] + row.dx + num_cores_x * destination_y]++;
+                    }
+                }
+                return;
+            }
+            CSRAM* csram = new CSRAM();
+            
             // Parse neurons
             for (rapidjson::Value::ConstValueIterator neuron_itr = neurons.Begin(); neuron_itr != neurons.End(); neuron_itr++) {
-                std::vector<bool> connections = parseNeuronConnections(core_itr, neuron_itr - neurons.Begin());
-                std::vector<int> weights(Config::parameters["num_weights"].GetInt());
-                weights = parseNeuronWeights(neuron_itr); 
-                std::vector<int> destination_core = parseNeuronDestinationCore(neuron_itr, coordinates[0], coordinates[1]);
-                int destination_axon = parseNeuronDestinationAxon(neuron_itr);
-                int destination_tick = parseNeuronDestinationTick(neuron_itr);
-                csram[neuron_itr - neurons.Begin()] = new CSRAMRow(connections, parseNeuronParameter(neuron_itr, "current_potential"), parseNeuronParameter(neuron_itr, "reset_potential"), parseNeuronParameter(neuron_itr, "leak"), parseNeuronParameter(neuron_itr, "positive_threshold"), parseNeuronParameter(neuron_itr, "negative_threshold"), weights, destination_core[0], destination_core[1], destination_tick, destination_axon, parseNeuronParameter(neuron_itr, "reset_mode"));
+                csram->setRow(neuron_itr - neurons.Begin(), parseNeuron(core_itr, neuron_itr, neuron_itr - neurons.Begin(), coordinates[0], coordinates[1]));
             }
             
             std::vector<int> neuron_instructions = parseCoreNeuronInstructions(core_itr);
             
             cores[coordinates[0] + num_cores_x * coordinates[1]] = new Core(NULL, NULL, NULL, NULL, csram, neuron_instructions, coordinates[0], coordinates[1]);
+        }, "Core json could not be parsed as an array object.");
+        
+        // Cores missing from the input stay unconfigured
+        for (int i = first_row*num_cores_x; i < end_row*num_cores_x; i++) {
+            if (cores[i] == NULL) {
+                cores[i] = new Core();
+            }
         }
         
         // Link cores
         Core* curr;
-        for (int y = 0; y < num_cores_y; y++) {
+        for (int y = first_row; y < end_row; y++) {
             for (int x = 0; x < num_cores_x; x++) {
                 int curr_index = x + y*num_cores_x;
                 curr = cores[curr_index];
@@ -357,15 +544,21 @@ namespace Decode {
                 if (x < num_cores_x - 1) {
                     curr->router->east = cores[curr_index + 1]->router;
                 }
-                if (y > 0) {
+                if (y > first_row) {
                     curr->router->south = cores[curr_index - num_cores_x]->router;
                 }
-                if (y < num_cores_y - 1) {
+                if (y < end_row - 1) {
                     curr->router->north = cores[curr_index + num_cores_x]->router;
                 }
             }
         }
         
+        // Resolve the scheduler of every neuron's destination now that every core is in place
+        for (int i = first_row*num_cores_x; i < end_row*num_cores_x; i++) {
+            cores[i]->token_controller->resolveDestinations(cores);
+            cores[i]->scheduler->fan_in += remote_fan_in[i];
+        }
+        
         return cores;
     }
 }
@@ -0,0 +1,174 @@
+/// haloexchange.cpp
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "haloexchange.h"
+
+HaloExchange::HaloExchange(int num_processes, int num_rows) {
+	this->rank = 0;
+	this->num_processes = num_processes;
+
+	for (int rank = 0; rank <= num_processes; rank++) {
+		first_rows.push_back(num_rows * rank / num_processes);
+	}
+	for (int rank = 0; rank < num_processes; rank++) {
+		for (int y = first_rows[rank]; y < first_rows[rank + 1]; y++) {
+			row_owners.push_back(rank);
+		}
+	}
+
+	// pairs[i][j] is the socket process i uses to talk to process j
+	std::vector<std::vector<int>> pairs(num_processes, std::vector<int>(num_processes, -1));
+	for (int i = 0; i < num_processes; i++) {
+		for (int j = i + 1; j < num_processes; j++) {
+			int pair[2];
+			if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+				throw HaloExchangeException("Could not create a socket pair: " + std::string(std::strerror(errno)));
+			}
+			pairs[i][j] = pair[0];
+			pairs[j][i] = pair[1];
+		}
+	}
+
+	for (int child = 1; child < num_processes; child++) {
+		pid_t pid = fork();
+		if (pid < 0) {
+			throw HaloExchangeException("Could not start process " + std::to_string(child) + ": " + std::string(std::strerror(errno)));
+		}
+		if (pid == 0) {
+			rank = child;
+			processes.clear();
+			break;
+		}
+		processes.push_back(pid);
+	}
+
+	// Keep only this process's end of each of its own pairs
+	for (int i = 0; i < num_processes; i++) {
+		for (int j = 0; j < num_processes; j++) {
+			if (pairs[i][j] != -1 && i != rank) {
+				close(pairs[i][j]);
+			}
+		}
+	}
+	sockets = pairs[rank];
+	for (int socket : sockets) {
+		if (socket != -1) {
+			fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+		}
+	}
+}
+
+HaloExchange::~HaloExchange() {
+	for (int socket : sockets) {
+		if (socket != -1) {
+			close(socket);
+		}
+	}
+}
+
+// Each message is sent as its length followed by its bytes
+void HaloExchange::exchange(const std::vector<std::string>& outgoing, std::vector<std::string>& incoming) {
+	std::vector<std::string> framed(num_processes);
+	std::vector<size_t> sent(num_processes, 0);
+	std::vector<uint64_t> lengths(num_processes, 0);
+	std::vector<size_t> received(num_processes, 0);
+	incoming.assign(num_processes, std::string());
+
+	int pending = 0;
+	for (int peer = 0; peer < num_processes; peer++) {
+		if (peer == rank) {
+			continue;
+		}
+		uint64_t length = outgoing[peer].size();
+		framed[peer] = std::string((const char*)&length, sizeof(length)) + outgoing[peer];
+		pending += 2;
+	}
+
+	std::vector<pollfd> polls;
+	std::vector<int> peers;
+	while (pending > 0) {
+		polls.clear();
+		peers.clear();
+		for (int peer = 0; peer < num_processes; peer++) {
+			if (peer == rank) {
+				continue;
+			}
+			short events = 0;
+			if (sent[peer] < framed[peer].size()) {
+				events |= POLLOUT;
+			}
+			if (received[peer] < sizeof(uint64_t) + lengths[peer]) {
+				events |= POLLIN;
+			}
+			if (events) {
+				pollfd poll_entry = {sockets[peer], events, 0};
+				polls.push_back(poll_entry);
+				peers.push_back(peer);
+			}
+		}
+		if (poll(&polls[0], polls.size(), -1) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw HaloExchangeException("Could not wait for other processes: " + std::string(std::strerror(errno)));
+		}
+
+		for (int i = 0; i < (int)polls.size(); i++) {
+			int peer = peers[i];
+			if (polls[i].revents & POLLOUT) {
+				ssize_t count = send(sockets[peer], framed[peer].data() + sent[peer], framed[peer].size() - sent[peer], MSG_NOSIGNAL);
+				if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+					throw HaloExchangeException("Lost connection to process " + std::to_string(peer) + ".");
+				}
+				sent[peer] += count > 0 ? count : 0;
+				if (sent[peer] == framed[peer].size()) {
+					pending--;
+				}
+			}
+			if (polls[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+				// Read the length first, then the rest of the message
+				ssize_t count;
+				if (received[peer] < sizeof(uint64_t)) {
+					count = recv(sockets[peer], (char*)&lengths[peer] + received[peer], sizeof(uint64_t) - received[peer], 0);
+				} else {
+					count = recv(sockets[peer], &incoming[peer][received[peer] - sizeof(uint64_t)], sizeof(uint64_t) + lengths[peer] - received[peer], 0);
+				}
+				if (count == 0 || (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+					throw HaloExchangeException("Lost connection to process " + std::to_string(peer) + ".");
+				}
+				received[peer] += count > 0 ? count : 0;
+				if (received[peer] == sizeof(uint64_t) && count > 0) {
+					incoming[peer].resize(lengths[peer]);
+				}
+				if (received[peer] == sizeof(uint64_t) + lengths[peer] && count > 0) {
+					pending--;
+				}
+			}
+		}
+	}
+}
+
+bool HaloExchange::waitForProcesses() {
+	bool succeeded = true;
+	for (pid_t pid : processes) {
+		int status;
+		if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			succeeded = false;
+		}
+	}
+	processes.clear();
+	return succeeded;
+}
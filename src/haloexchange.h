@@ -0,0 +1,70 @@
+/// haloexchange.h
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#ifndef HALOEXCHANGE_H
+#define HALOEXCHANGE_H
+
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+// Thrown when a process cannot be started or stops answering
+class HaloExchangeException : public std::exception {
+	public:
+		std::string message;
+
+		HaloExchangeException(std::string message) {
+			this->message = message;
+		}
+
+		virtual const char* what() const throw () {
+			return message.c_str();
+		}
+};
+
+/**
+ * @brief Splits the rows of the grid between processes and carries the messages between them.
+ * 
+ * The process that creates the exchange forks the others, after connecting
+ * every pair of processes with a Unix socket pair, and each process returns
+ * from the constructor with its own `rank`. Process 0 is the one that was
+ * started. Each process owns a band of consecutive rows, so the cores of
+ * lower ranks always come first in grid order.
+ * 
+ * exchange sends one message to every other process and receives one from
+ * each, which doubles as the barrier between ticks. Sockets are written and
+ * read as they become ready, so large messages in both directions cannot
+ * block each other. The messages are plain byte strings, so the same calls
+ * would work over TCP between hosts.
+ */
+class HaloExchange {
+	public:
+		// Starts `num_processes` - 1 more processes and splits `num_rows` rows between them
+		HaloExchange(int num_processes, int num_rows);
+		~HaloExchange();
+
+		int rank;
+		int num_processes;
+		int ownerOfRow(int y) { return row_owners[y]; }
+		int firstRow(int rank) { return first_rows[rank]; }
+		int endRow(int rank) { return first_rows[rank + 1]; }
+
+		// Sends `outgoing[rank]` to each other process and fills `incoming[rank]` with what it sent back
+		void exchange(const std::vector<std::string>& outgoing, std::vector<std::string>& incoming);
+		// On process 0, waits for every other process to exit and returns whether they all succeeded
+		bool waitForProcesses();
+
+	private:
+		// The socket connected to each process, or -1 for this one
+		std::vector<int> sockets;
+		std::vector<pid_t> processes;
+		std::vector<int> first_rows;
+		std::vector<int> row_owners;
+};
+
+#endif // HALOEXCHANGE_H
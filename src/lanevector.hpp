@@ -0,0 +1,84 @@
+/// lanevector.hpp
+///
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+
+#ifndef LANEVECTOR_H
+#define LANEVECTOR_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief A vector of per-neuron values stored in either 16-bit or 32-bit lanes.
+ *
+ * When the configured potential width fits in 16 bits, the neuron state is
+ * stored in int16_t lanes so that the vector kernels process twice as many
+ * neurons per instruction and stream half as many bytes. Element access
+ * converts to and from int, while kernels work on the lanes directly through
+ * `data<Lane>()`, where Lane must match isNarrow().
+ */
+class LaneVector {
+    public:
+        LaneVector() {
+            narrow = false;
+        }
+
+        LaneVector(int size, bool narrow) {
+            this->narrow = narrow;
+            if (narrow) {
+                narrow_lanes = std::vector<int16_t>(size);
+            } else {
+                wide_lanes = std::vector<int32_t>(size);
+            }
+        }
+
+        int get(int index) const {
+            return narrow ? narrow_lanes[index] : wide_lanes[index];
+        }
+
+        void set(int index, int value) {
+            if (narrow) {
+                narrow_lanes[index] = value;
+            } else {
+                wide_lanes[index] = value;
+            }
+        }
+
+        bool isNarrow() const {
+            return narrow;
+        }
+
+        template <typename Lane>
+        Lane* data();
+
+        template <typename Lane>
+        const Lane* data() const;
+
+    private:
+        bool narrow;
+        std::vector<int16_t> narrow_lanes;
+        std::vector<int32_t> wide_lanes;
+};
+
+template <>
+inline int16_t* LaneVector::data<int16_t>() {
+    return &narrow_lanes[0];
+}
+
+template <>
+inline int32_t* LaneVector::data<int32_t>() {
+    return &wide_lanes[0];
+}
+
+template <>
+inline const int16_t* LaneVector::data<int16_t>() const {
+    return &narrow_lanes[0];
+}
+
+template <>
+inline const int32_t* LaneVector::data<int32_t>() const {
+    return &wide_lanes[0];
+}
+
+#endif // LANEVECTOR_H
@@ -0,0 +1,90 @@
+/// linkcounters.cpp
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "linkcounters.h"
+
+static const char* DIRECTION_NAMES[] = {"north", "south", "east", "west"};
+
+LinkCounters::LinkCounters(int num_cores_x, int num_cores_y, std::string file_name, int interval) {
+	this->num_cores_x = num_cores_x;
+	this->num_cores_y = num_cores_y;
+	this->interval = interval;
+	this->last_written = -1;
+	packets = std::vector<long long>(num_cores_x * num_cores_y * 4);
+	hops = std::vector<long long>(packets.size());
+	max_tick_packets = std::vector<int>(packets.size());
+	tick_packets = std::vector<int>(packets.size());
+
+	out.open(file_name.c_str());
+	if (out.is_open()) {
+		out << "tick,x,y,direction,packets,hops,max_tick_packets" << std::endl;
+	}
+}
+
+void LinkCounters::recordRoute(int x, int y, int dx, int dy) {
+	int route_hops = std::abs(dx) + std::abs(dy);
+	for (; dx > 0; dx--, x++) {
+		count(x, y, EAST, route_hops);
+	}
+	for (; dx < 0; dx++, x--) {
+		count(x, y, WEST, route_hops);
+	}
+	for (; dy > 0; dy--, y++) {
+		count(x, y, NORTH, route_hops);
+	}
+	for (; dy < 0; dy++, y--) {
+		count(x, y, SOUTH, route_hops);
+	}
+}
+
+// Counts a packet taking `route_hops` hops in all on a link
+void LinkCounters::count(int x, int y, Direction direction, int route_hops) {
+	int link = (x + y * num_cores_x) * 4 + direction;
+	hops[link] += route_hops;
+	if (tick_packets[link]++ == 0) {
+		tick_links.push_back(link);
+	}
+}
+
+void LinkCounters::endTick(int tick) {
+	for (int link : tick_links) {
+		packets[link] += tick_packets[link];
+		max_tick_packets[link] = std::max(max_tick_packets[link], tick_packets[link]);
+		tick_packets[link] = 0;
+	}
+	tick_links.clear();
+
+	if (interval > 0 && (tick + 1) % interval == 0) {
+		write(tick + 1);
+	}
+}
+
+void LinkCounters::finish(int num_ticks) {
+	if (last_written != num_ticks) {
+		write(num_ticks);
+	}
+	out.flush();
+}
+
+// Writes a row for every link that leads to another core, after `ticks` ticks.
+void LinkCounters::write(int ticks) {
+	for (int y = 0; y < num_cores_y; y++) {
+		for (int x = 0; x < num_cores_x; x++) {
+			bool exists[] = {y < num_cores_y - 1, y > 0, x < num_cores_x - 1, x > 0};
+			for (int direction = NORTH; direction <= WEST; direction++) {
+				if (!exists[direction]) {
+					continue;
+				}
+				int link = (x + y * num_cores_x) * 4 + direction;
+				out << ticks << "," << x << "," << y << "," << DIRECTION_NAMES[direction] << "," << packets[link] << "," << hops[link] << "," << max_tick_packets[link] << "\n";
+			}
+		}
+	}
+	last_written = ticks;
+}
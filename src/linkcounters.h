@@ -0,0 +1,64 @@
+/// linkcounters.h
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#ifndef LINKCOUNTERS_H
+#define LINKCOUNTERS_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Counts the packets crossing each link of the mesh.
+ * 
+ * Every router has a link in each of the four directions. A packet from core
+ * (x, y) travelling dx, dy crosses the east or west links along row y and
+ * then the north or south links along column x + dx, as dimension-order
+ * routing sends it, so the links are counted from a packet's offsets whether
+ * or not it actually walks the mesh. Counts are kept in flat arrays indexed by
+ * (x + y * num_cores_x) * 4 + direction, along with the total hops of the
+ * packets that crossed each link and the most packets it carried in a single
+ * tick.
+ * 
+ * The counters are written to a CSV file with one row per link, the tick they
+ * were taken at and the link's source core and direction, every `interval`
+ * ticks and at the end of the run.
+ */
+class LinkCounters {
+	public:
+		enum Direction { NORTH, SOUTH, EAST, WEST };
+
+		// Opens `file_name` for writing. Check isOpen before using the counters.
+		LinkCounters(int num_cores_x, int num_cores_y, std::string file_name, int interval);
+
+		bool isOpen() { return out.is_open(); }
+
+		// Counts a packet leaving core (`x`, `y`) for the core `dx`, `dy` away
+		void recordRoute(int x, int y, int dx, int dy);
+		// Closes the per-tick loads of `tick`, writing the counters if `tick` ends an interval
+		void endTick(int tick);
+		// Writes the counters after the last tick, `num_ticks`, unless they were just written
+		void finish(int num_ticks);
+
+	private:
+		void count(int x, int y, Direction direction, int route_hops);
+		void write(int ticks);
+
+		int num_cores_x;
+		int num_cores_y;
+		int interval;
+		int last_written;
+		std::ofstream out;
+
+		std::vector<long long> packets;
+		std::vector<long long> hops;
+		std::vector<int> max_tick_packets;
+		// Packets of the current tick, and the links they have been counted on
+		std::vector<int> tick_packets;
+		std::vector<int> tick_links;
+};
+
+#endif // LINKCOUNTERS_H
@@ -5,6 +5,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <limits>
 
 #include <cxxopts.hpp>
 #include <plog/Log.h>
@@ -18,9 +19,17 @@
 #include "packet.h"
 #include "config.hpp"
 #include "core.h"
+#include "neuronkernel.h"
+#include "tokencontroller.h"
+#include "router.h"
+#include "scheduler.h"
+#include "linkcounters.h"
+#include "nocmodel.h"
+#include "haloexchange.h"
 
 // Global parameters for simulation
-rapidjson::Document Config::parameters;
+ConfigParameters Config::loaded;
+const ConfigParameters& Config::parameters = Config::loaded;
 
 int main(int argc, char *argv[]) {
 
@@ -32,6 +41,21 @@ int main(int argc, char *argv[]) {
         ("ticks", "Number of ticks to run simulation for", cxxopts::value<int>())
         ("t,trace", "Trace file", cxxopts::value<std::string>())
         ("r,report_freq", "Report frequency", cxxopts::value<int>()->default_value("1"))
+        ("integration", "Integration order (auto, neuron, axon)", cxxopts::value<std::string>()->default_value("auto"))
+        ("simd", "Neuron kernel instruction set (auto, scalar, avx2, avx512)", cxxopts::value<std::string>()->default_value("auto"))
+        ("routing", "Packet routing (direct, mesh, contention)", cxxopts::value<std::string>()->default_value("direct"))
+        ("noc_fifo_depth", "Packets each router input FIFO holds with contention routing", cxxopts::value<int>()->default_value("4"))
+        ("noc_cycles_per_tick", "Mesh cycles in a tick with contention routing", cxxopts::value<int>()->default_value("1000"))
+        ("scheduler", "Scheduler storage (dense, sparse, or auto to pick from each core's configured fan-in)", cxxopts::value<std::string>()->default_value("auto"))
+        ("threads", "Number of threads to run the cores of each tick on", cxxopts::value<int>()->default_value("1"))
+        ("partition", "How cores are split between threads (runs, tiles)", cxxopts::value<std::string>()->default_value("runs"))
+        ("delivery", "How spikes are split between threads when written to their schedulers (partitioned, atomic)", cxxopts::value<std::string>()->default_value("partitioned"))
+        ("processes", "Number of local processes to split the rows of cores between", cxxopts::value<int>()->default_value("1"))
+        ("stats", "Print routing and thread statistics after the simulation")
+        ("warning_samples", "Number of dropped spike warnings to print as they happen", cxxopts::value<int>()->default_value("10"))
+        ("strict", "Stop the simulation at the first dropped spike")
+        ("link_stats", "Write packet counts of every mesh link to a CSV file", cxxopts::value<std::string>())
+        ("link_stats_interval", "Also write link counts every this many ticks", cxxopts::value<int>()->default_value("0"))
         ("h,help", "Print help");
 
     options.positional_help("INPUT_FILE_NAME, OUTPUT_FILE_NAME, CONFIGURATION_FILE_NAME, NUM_TICKS");
@@ -66,7 +90,12 @@ int main(int argc, char *argv[]) {
     }
 
     if (result.count("config")) {
-        Config::setParameters(result["config"].as<std::string>());
+        try {
+            Config::setParameters(result["config"].as<std::string>());
+        } catch (const ConfigDecodingException& e) {
+            std::cout << "[ERROR] Error parsing config: " << e.message << std::endl;
+            return 1;
+        }
     } else {
         std::cout << "[ERROR] Config file not specified." << std::endl << std::endl;
         std::cout << options.help() << std::endl;
@@ -87,6 +116,78 @@ int main(int argc, char *argv[]) {
         report_frequency = 1;
     }
 
+    if (result["integration"].as<std::string>() == "neuron") {
+        TokenController::integration_order = TokenController::NEURON_MAJOR;
+    } else if (result["integration"].as<std::string>() == "axon") {
+        TokenController::integration_order = TokenController::AXON_MAJOR;
+    } else if (result["integration"].as<std::string>() != "auto") {
+        std::cout << "[ERROR] Unknown integration order " << result["integration"].as<std::string>() << "." << std::endl << std::endl;
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
+    if (result["routing"].as<std::string>() == "mesh") {
+        Router::routing_mode = Router::MESH;
+    } else if (result["routing"].as<std::string>() == "contention") {
+        if (result["noc_fifo_depth"].as<int>() < 1 || result["noc_cycles_per_tick"].as<int>() < 1) {
+            std::cout << "[ERROR] noc_fifo_depth and noc_cycles_per_tick must be at least 1." << std::endl << std::endl;
+            std::cout << options.help() << std::endl;
+            return 0;
+        }
+        Router::routing_mode = Router::CONTENTION;
+        Router::noc_model = new NocModel(Config::parameters.num_cores_x, Config::parameters.num_cores_y, result["noc_fifo_depth"].as<int>(), result["noc_cycles_per_tick"].as<int>());
+    } else if (result["routing"].as<std::string>() != "direct") {
+        std::cout << "[ERROR] Unknown routing " << result["routing"].as<std::string>() << "." << std::endl << std::endl;
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+    Router::record_statistics = result.count("stats") > 0;
+    if (result["threads"].as<int>() < 1) {
+        std::cout << "[ERROR] threads must be at least 1." << std::endl << std::endl;
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+    TrueNorthGrid::num_threads = result["threads"].as<int>();
+    if (result["partition"].as<std::string>() == "tiles") {
+        TrueNorthGrid::partition = TrueNorthGrid::TILES;
+    } else if (result["partition"].as<std::string>() != "runs") {
+        std::cout << "[ERROR] Unknown partition " << result["partition"].as<std::string>() << "." << std::endl << std::endl;
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+    if (result["delivery"].as<std::string>() == "atomic") {
+        TrueNorthGrid::delivery = TrueNorthGrid::ATOMIC;
+    } else if (result["delivery"].as<std::string>() != "partitioned") {
+        std::cout << "[ERROR] Unknown delivery " << result["delivery"].as<std::string>() << "." << std::endl << std::endl;
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+    Scheduler::warning_samples = result["warning_samples"].as<int>();
+    Scheduler::strict_warnings = result.count("strict") > 0;
+    if (result.count("link_stats")) {
+        Router::link_counters = new LinkCounters(Config::parameters.num_cores_x, Config::parameters.num_cores_y, result["link_stats"].as<std::string>(), result["link_stats_interval"].as<int>());
+        if (!Router::link_counters->isOpen()) {
+            std::cout << "[ERROR] Could not open link statistics file " << result["link_stats"].as<std::string>() << "." << std::endl;
+            return 1;
+        }
+    }
+
+    if (result["scheduler"].as<std::string>() == "dense") {
+        Scheduler::storage = Scheduler::DENSE;
+    } else if (result["scheduler"].as<std::string>() == "sparse") {
+        Scheduler::storage = Scheduler::SPARSE;
+    } else if (result["scheduler"].as<std::string>() != "auto") {
+        std::cout << "[ERROR] Unknown scheduler storage " << result["scheduler"].as<std::string>() << "." << std::endl << std::endl;
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
+    if (!NeuronKernel::select(result["simd"].as<std::string>())) {
+        std::cout << "[ERROR] Neuron kernel " << result["simd"].as<std::string>() << " is unknown or not supported by this CPU." << std::endl << std::endl;
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
     if (Config::traceSpecified()) {
         if (result.count("trace")) {
             std::remove(result["trace"].as<std::string>().c_str());
@@ -98,24 +199,122 @@ int main(int argc, char *argv[]) {
             return 0;
         }
     } else if (result.count("trace")) {
-        std::cout << "[ERROR] Trace file specified but trace verbosity is set to " << std::to_string(Config::parameters["trace_verbosity"].GetInt()) << "." << std::endl << std::endl;
+        std::cout << "[ERROR] Trace file specified but every trace verbosity is set to 0." << std::endl << std::endl;
         std::cout << options.help() << std::endl;
         return 0;
     }
 
+    int num_processes = result["processes"].as<int>();
+    if (num_processes < 1 || num_processes > Config::parameters.num_cores_y) {
+        std::cout << "[ERROR] processes must be between 1 and the number of rows of cores." << std::endl << std::endl;
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+    if (num_processes > 1 && (Router::routing_mode != Router::DIRECT || Config::traceSpecified() || Router::link_counters != NULL || Scheduler::strict_warnings)) {
+        std::cout << "[ERROR] Multiple processes need direct routing and cannot be combined with tracing, link_stats or strict." << std::endl << std::endl;
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
+    // Each process parses only the cores in its own rows
+    int first_row = 0;
+    int end_row = Config::parameters.num_cores_y;
+    if (num_processes > 1) {
+        std::cout.flush();
+        try {
+            TrueNorthGrid::halo_exchange = new HaloExchange(num_processes, Config::parameters.num_cores_y);
+        } catch (const HaloExchangeException& e) {
+            std::cout << "[ERROR] Could not start processes: " << e.message << std::endl;
+            return 1;
+        }
+        first_row = TrueNorthGrid::halo_exchange->firstRow(TrueNorthGrid::halo_exchange->rank);
+        end_row = TrueNorthGrid::halo_exchange->endRow(TrueNorthGrid::halo_exchange->rank);
+    }
+
     std::vector<std::vector<Packet*>> input_packets;
     std::vector<Core*> cores;
 
+    std::string parse_error;
     try {
         input_packets = Decode::parseInputPackets(input_file_name, ticks);
-        cores = Decode::parseCores(input_file_name);
+        cores = Decode::parseCores(input_file_name, first_row, end_row);
     } catch (const Decode::InputDecodingException& e) {
-        std::cout << "[ERROR] Error parsing input: " << e.message << std::endl;
+        parse_error = e.message;
+    }
+
+    // Processes share their parse errors before the first tick, so that process 0 reports the error of
+    // the lowest rank and the others stop with it instead of losing their connection to it
+    HaloExchange* halo_exchange = TrueNorthGrid::halo_exchange;
+    if (halo_exchange != NULL) {
+        std::vector<std::string> parse_errors;
+        try {
+            halo_exchange->exchange(std::vector<std::string>(num_processes, parse_error), parse_errors);
+        } catch (const HaloExchangeException& e) {
+            std::cout << "[ERROR] Process " << halo_exchange->rank << " stopped: " << e.message << std::endl;
+            return 1;
+        }
+        parse_errors[halo_exchange->rank] = parse_error;
+        for (const std::string& error : parse_errors) {
+            if (!error.empty()) {
+                parse_error = error;
+                break;
+            }
+        }
+    }
+    if (!parse_error.empty()) {
+        if (halo_exchange == NULL || halo_exchange->rank == 0) {
+            std::cout << "[ERROR] Error parsing input: " << parse_error << std::endl;
+        }
+        if (halo_exchange != NULL) {
+            halo_exchange->waitForProcesses();
+        }
         return 1;
     }
 
     TrueNorthGrid grid = TrueNorthGrid(input_packets, cores);
-    grid.beginActivity(ticks, report_frequency);
+    try {
+        grid.beginActivity(ticks, report_frequency);
+    } catch (const SchedulerWarningException& e) {
+        std::cout << "[ERROR] Stopped in strict mode: " << e.message << std::endl;
+        return 1;
+    } catch (const HaloExchangeException& e) {
+        std::cout << "[ERROR] Process " << TrueNorthGrid::halo_exchange->rank << " stopped: " << e.message << std::endl;
+        return 1;
+    }
+
+    // Only process 0 reports; the others have sent it everything it needs
+    if (halo_exchange != NULL && halo_exchange->rank > 0) {
+        return 0;
+    }
+
+    if (Router::record_statistics) {
+        std::cout << "Routed " << Router::statistics.packets << " packets over " << Router::statistics.hops << " hops";
+        if (Router::statistics.packets > 0) {
+            std::cout << " (" << (double)Router::statistics.hops / Router::statistics.packets << " hops per packet, at most " << Router::statistics.max_hops << ")";
+        }
+        std::cout << "." << std::endl;
+    }
+
+    ThreadPool* pool = grid.threadPool();
+    if (Router::record_statistics && pool != NULL && pool->size() > 1) {
+        for (int thread = 0; thread < pool->size(); thread++) {
+            const ThreadPool::ThreadStats& stats = pool->stats[thread];
+            std::cout << "Thread " << thread << " ran " << stats.tasks << " tasks and stole " << stats.steals << " times, busy for " << stats.busy_seconds << " s." << std::endl;
+        }
+    }
+
+    if (Router::noc_model != NULL) {
+        NocModel* model = Router::noc_model;
+        std::cout << "Mesh contention: " << model->stalled_packets << " of " << model->packets << " packets stalled for " << model->stall_cycles << " cycles, and " << model->late_packets << " arrived after " << model->cycles_per_tick << " cycles." << std::endl;
+        if (model->busiest_tick >= 0) {
+            std::cout << "The busiest tick, tick " << model->busiest_tick + 1 << ", took " << model->max_cycles << " cycles, so the mesh sustains at most one tick every " << model->max_cycles << " cycles." << std::endl;
+        }
+    }
+
+    if (halo_exchange != NULL && !halo_exchange->waitForProcesses()) {
+        std::cout << "[ERROR] A process did not finish the simulation." << std::endl;
+        return 1;
+    }
 
     return 0;
 }
@@ -4,16 +4,55 @@
 ///
 ///
 
+#include <algorithm>
 #include <string>
 
 #include "neuronblock.h"
+#include "bitword.hpp"
+#include "config.hpp"
 
-void NeuronBlock::integrate(std::vector<int> synaptic_weights, int neuron_instruction) {
-	current_potential += synaptic_weights[neuron_instruction];
+NeuronBlock::NeuronBlock() {
+	current_potential = 0;
+	min_potential = Config::parameters.min_potential;
+	max_potential = Config::parameters.max_potential;
+}
+
+void NeuronBlock::integrate(const int* synaptic_weights, int neuron_instruction) {
+	current_potential = saturate(current_potential + synaptic_weights[neuron_instruction]);
+}
+
+// Integrates every active connection at once. `axon_type_masks` holds one packed mask per axon
+// type (the axons whose neuron instruction is that type), so the number of active connections
+// of each type is a popcount and each weight is applied only once.
+// 
+// Integration saturates after every spike in axon order, which only matches a single sum when no
+// partial sum can leave the potential bounds. Otherwise this returns false without changing the
+// potential, and the spikes must be integrated one at a time with integrate.
+bool NeuronBlock::integrateByType(const int* synaptic_weights, int num_weights, const uint64_t* connections, const uint64_t* spikes, const uint64_t* axon_type_masks, int num_words) {
+	int64_t rising = 0, falling = 0;
+	for (int word = 0; word < num_words; word++) {
+		uint64_t active = connections[word] & spikes[word];
+		if (!active) {
+			continue;
+		}
+		for (int type = 0; type < num_weights; type++) {
+			int64_t input = (int64_t)synaptic_weights[type] * BitWord::popcount(active & axon_type_masks[type * num_words + word]);
+			if (input > 0) {
+				rising += input;
+			} else {
+				falling += input;
+			}
+		}
+	}
+	if (current_potential + rising > max_potential || current_potential + falling < min_potential) {
+		return false;
+	}
+	current_potential += rising + falling;
+	return true;
 }
 
 void NeuronBlock::leak(int leak){
-	current_potential += leak;
+	current_potential = saturate(current_potential + leak);
 }
 
 bool NeuronBlock::spikes(int positive_threshold){
@@ -26,7 +65,7 @@ int NeuronBlock::output_potential(int positive_threshold, int negative_threshold
 			case 0:
 				return reset_potential;
 			case 1:
-				return current_potential - positive_threshold;
+				return saturate(current_potential - positive_threshold);
 			default:
 				throw "[ERROR] Reset mode of " + std::to_string(reset_mode) + " out of range of acceptable reset modes.";
 				
@@ -34,9 +73,9 @@ int NeuronBlock::output_potential(int positive_threshold, int negative_threshold
 	} else if (current_potential < negative_threshold) {
 		switch (reset_mode) {
 			case 0:
-				return -reset_potential;
+				return saturate(-reset_potential);
 			case 1:
-				return current_potential + negative_threshold;
+				return saturate(current_potential + negative_threshold);
 			default:
 				throw "[ERROR] Reset mode of " + std::to_string(reset_mode) + " out of range of acceptable reset modes.";
 		}
@@ -44,3 +83,7 @@ int NeuronBlock::output_potential(int positive_threshold, int negative_threshold
 		return current_potential;
 	}
 }
+
+int NeuronBlock::saturate(int potential) {
+	return std::min(std::max(potential, min_potential), max_potential);
+}
\ No newline at end of file
@@ -7,20 +7,30 @@
 #ifndef NEURONBLOCK_H
 #define NEURONBLOCK_H
 
-#include <vector>
+#include <cstdint>
 
 /**
  * @brief Performs the leaky integrate and fire operation for a neuron.
  * 
+ * Every operation saturates the potential at the bounds of the configured
+ * potential width.
  */
 class NeuronBlock {
 	public:
-		void integrate(std::vector<int> synaptic_weights, int neuron_instruction);
+		NeuronBlock();
+
+		void integrate(const int* synaptic_weights, int neuron_instruction);
+		bool integrateByType(const int* synaptic_weights, int num_weights, const uint64_t* connections, const uint64_t* spikes, const uint64_t* axon_type_masks, int num_words);
 		void leak(int leak);
 		bool spikes(int positive_threshold);
 		int output_potential(int positive_threshold, int negative_threshold, int reset_potential, int reset_mode);
 
 		int current_potential;
+		int min_potential;
+		int max_potential;
+
+	private:
+		int saturate(int potential);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,430 @@
+/// neuronkernel.cpp
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#include <algorithm>
+
+#include "neuronkernel.h"
+#include "bitword.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NEURON_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+namespace NeuronKernel {
+
+	static inline int saturate(int potential, int min_potential, int max_potential) {
+		return std::min(std::max(potential, min_potential), max_potential);
+	}
+
+	// Handles neurons [begin, end), or the tail left over by a vectorized version. Lanes are widened
+	// to int, so 16-bit lanes cannot overflow before saturating.
+	template <typename Lane>
+	static void leakAndFireScalar(int begin, int end, Lane* current_potential, const Lane* leak, const Lane* positive_threshold, const Lane* negative_threshold, const Lane* reset_potential, const Lane* reset_mode, int min_potential, int max_potential, uint64_t* fired) {
+		for (int neuron = begin; neuron < end; neuron++) {
+			int potential = saturate(current_potential[neuron] + leak[neuron], min_potential, max_potential);
+			bool linear = reset_mode[neuron] == 1;
+			if (potential >= positive_threshold[neuron]) {
+				BitWord::set(fired, neuron);
+				potential = linear ? potential - positive_threshold[neuron] : reset_potential[neuron];
+			} else if (potential < negative_threshold[neuron]) {
+				potential = linear ? potential + negative_threshold[neuron] : -reset_potential[neuron];
+			}
+			current_potential[neuron] = saturate(potential, min_potential, max_potential);
+		}
+	}
+
+	template <int NUM_NEURONS, typename Lane>
+	static void leakAndFireScalar(int num_neurons, Lane* current_potential, const Lane* leak, const Lane* positive_threshold, const Lane* negative_threshold, const Lane* reset_potential, const Lane* reset_mode, int min_potential, int max_potential, uint64_t* fired) {
+		leakAndFireScalar(0, NUM_NEURONS ? NUM_NEURONS : num_neurons, current_potential, leak, positive_threshold, negative_threshold, reset_potential, reset_mode, min_potential, max_potential, fired);
+	}
+
+	// Adds the weights of the neurons set in bits [begin, end) of `neurons`.
+	template <typename Lane>
+	static void addMaskedWeightsScalar(int begin, int end, Lane* current_potential, const Lane* weights, const uint64_t* neurons, int min_potential, int max_potential) {
+		for (int word = begin / BitWord::BITS_PER_WORD; word * BitWord::BITS_PER_WORD < end; word++) {
+			uint64_t bits = neurons[word];
+			if (word * BitWord::BITS_PER_WORD < begin) {
+				bits &= ~(uint64_t)0 << (begin % BitWord::BITS_PER_WORD);
+			}
+			while (bits) {
+				int neuron = word * BitWord::BITS_PER_WORD + BitWord::countTrailingZeros(bits);
+				current_potential[neuron] = saturate(current_potential[neuron] + weights[neuron], min_potential, max_potential);
+				bits &= bits - 1;
+			}
+		}
+	}
+
+	template <int NUM_NEURONS, typename Lane>
+	static void addMaskedWeightsScalar(int num_neurons, Lane* current_potential, const Lane* weights, const uint64_t* neurons, int min_potential, int max_potential) {
+		addMaskedWeightsScalar(0, NUM_NEURONS ? NUM_NEURONS : num_neurons, current_potential, weights, neurons, min_potential, max_potential);
+	}
+
+#ifdef NEURON_KERNEL_X86
+	// The vector versions saturate by clamping after every step that can move the potential. With
+	// 32-bit lanes below a potential width of 32 the potential and parameter widths leave headroom
+	// for a plain add, while at 32 the add keeps plain int32 arithmetic. With 16-bit lanes the
+	// saturating adds stop at the lane limits before the clamp.
+
+	// 8 neurons per iteration. Comparisons produce all-ones lanes that drive byte blends.
+	template <int NUM_NEURONS>
+	__attribute__((target("avx2")))
+	static void leakAndFireAVX2(int num_neurons, int32_t* current_potential, const int32_t* leak, const int32_t* positive_threshold, const int32_t* negative_threshold, const int32_t* reset_potential, const int32_t* reset_mode, int min_potential, int max_potential, uint64_t* fired) {
+		if (NUM_NEURONS) {
+			num_neurons = NUM_NEURONS;
+		}
+		const __m256i one = _mm256_set1_epi32(1);
+		const __m256i lower = _mm256_set1_epi32(min_potential);
+		const __m256i upper = _mm256_set1_epi32(max_potential);
+		int neuron = 0;
+		for (; neuron + 8 <= num_neurons; neuron += 8) {
+			__m256i potential = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(current_potential + neuron)), _mm256_loadu_si256((const __m256i*)(leak + neuron)));
+			potential = _mm256_min_epi32(_mm256_max_epi32(potential, lower), upper);
+			__m256i positive = _mm256_loadu_si256((const __m256i*)(positive_threshold + neuron));
+			__m256i negative = _mm256_loadu_si256((const __m256i*)(negative_threshold + neuron));
+			__m256i reset = _mm256_loadu_si256((const __m256i*)(reset_potential + neuron));
+			__m256i linear = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(reset_mode + neuron)), one);
+
+			// potential >= positive is !(positive > potential)
+			__m256i below_positive = _mm256_cmpgt_epi32(positive, potential);
+			__m256i below_negative = _mm256_cmpgt_epi32(negative, potential);
+
+			__m256i positive_reset = _mm256_blendv_epi8(reset, _mm256_sub_epi32(potential, positive), linear);
+			__m256i negative_reset = _mm256_blendv_epi8(_mm256_sub_epi32(_mm256_setzero_si256(), reset), _mm256_add_epi32(potential, negative), linear);
+
+			__m256i result = _mm256_blendv_epi8(potential, negative_reset, below_negative);
+			result = _mm256_blendv_epi8(positive_reset, result, below_positive);
+			_mm256_storeu_si256((__m256i*)(current_potential + neuron), _mm256_min_epi32(_mm256_max_epi32(result, lower), upper));
+
+			uint64_t spikes = ~_mm256_movemask_ps(_mm256_castsi256_ps(below_positive)) & 0xFF;
+			fired[neuron / BitWord::BITS_PER_WORD] |= spikes << (neuron % BitWord::BITS_PER_WORD);
+		}
+		leakAndFireScalar(neuron, num_neurons, current_potential, leak, positive_threshold, negative_threshold, reset_potential, reset_mode, min_potential, max_potential, fired);
+	}
+
+	// 16 neurons per iteration. The comparison lanes are packed to bytes to collect the spikes.
+	template <int NUM_NEURONS>
+	__attribute__((target("avx2")))
+	static void leakAndFireAVX2(int num_neurons, int16_t* current_potential, const int16_t* leak, const int16_t* positive_threshold, const int16_t* negative_threshold, const int16_t* reset_potential, const int16_t* reset_mode, int min_potential, int max_potential, uint64_t* fired) {
+		if (NUM_NEURONS) {
+			num_neurons = NUM_NEURONS;
+		}
+		const __m256i one = _mm256_set1_epi16(1);
+		const __m256i lower = _mm256_set1_epi16(min_potential);
+		const __m256i upper = _mm256_set1_epi16(max_potential);
+		int neuron = 0;
+		for (; neuron + 16 <= num_neurons; neuron += 16) {
+			__m256i potential = _mm256_adds_epi16(_mm256_loadu_si256((const __m256i*)(current_potential + neuron)), _mm256_loadu_si256((const __m256i*)(leak + neuron)));
+			potential = _mm256_min_epi16(_mm256_max_epi16(potential, lower), upper);
+			__m256i positive = _mm256_loadu_si256((const __m256i*)(positive_threshold + neuron));
+			__m256i negative = _mm256_loadu_si256((const __m256i*)(negative_threshold + neuron));
+			__m256i reset = _mm256_loadu_si256((const __m256i*)(reset_potential + neuron));
+			__m256i linear = _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i*)(reset_mode + neuron)), one);
+
+			__m256i below_positive = _mm256_cmpgt_epi16(positive, potential);
+			__m256i below_negative = _mm256_cmpgt_epi16(negative, potential);
+
+			__m256i positive_reset = _mm256_blendv_epi8(reset, _mm256_subs_epi16(potential, positive), linear);
+			__m256i negative_reset = _mm256_blendv_epi8(_mm256_subs_epi16(_mm256_setzero_si256(), reset), _mm256_adds_epi16(potential, negative), linear);
+
+			__m256i result = _mm256_blendv_epi8(potential, negative_reset, below_negative);
+			result = _mm256_blendv_epi8(positive_reset, result, below_positive);
+			_mm256_storeu_si256((__m256i*)(current_potential + neuron), _mm256_min_epi16(_mm256_max_epi16(result, lower), upper));
+
+			__m128i below_positive_bytes = _mm_packs_epi16(_mm256_castsi256_si128(below_positive), _mm256_extracti128_si256(below_positive, 1));
+			uint64_t spikes = ~_mm_movemask_epi8(below_positive_bytes) & 0xFFFF;
+			fired[neuron / BitWord::BITS_PER_WORD] |= spikes << (neuron % BitWord::BITS_PER_WORD);
+		}
+		leakAndFireScalar(neuron, num_neurons, current_potential, leak, positive_threshold, negative_threshold, reset_potential, reset_mode, min_potential, max_potential, fired);
+	}
+
+	// 16 neurons per iteration. Comparisons produce mask registers that drive masked blends.
+	template <int NUM_NEURONS>
+	__attribute__((target("avx512f")))
+	static void leakAndFireAVX512(int num_neurons, int32_t* current_potential, const int32_t* leak, const int32_t* positive_threshold, const int32_t* negative_threshold, const int32_t* reset_potential, const int32_t* reset_mode, int min_potential, int max_potential, uint64_t* fired) {
+		if (NUM_NEURONS) {
+			num_neurons = NUM_NEURONS;
+		}
+		const __m512i one = _mm512_set1_epi32(1);
+		const __m512i lower = _mm512_set1_epi32(min_potential);
+		const __m512i upper = _mm512_set1_epi32(max_potential);
+		int neuron = 0;
+		for (; neuron + 16 <= num_neurons; neuron += 16) {
+			__m512i potential = _mm512_add_epi32(_mm512_loadu_si512(current_potential + neuron), _mm512_loadu_si512(leak + neuron));
+			potential = _mm512_min_epi32(_mm512_max_epi32(potential, lower), upper);
+			__m512i positive = _mm512_loadu_si512(positive_threshold + neuron);
+			__m512i negative = _mm512_loadu_si512(negative_threshold + neuron);
+			__m512i reset = _mm512_loadu_si512(reset_potential + neuron);
+			__mmask16 linear = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(reset_mode + neuron), one);
+
+			__mmask16 spikes = _mm512_cmpge_epi32_mask(potential, positive);
+			__mmask16 below_negative = _mm512_cmplt_epi32_mask(potential, negative);
+
+			__m512i positive_reset = _mm512_mask_blend_epi32(linear, reset, _mm512_sub_epi32(potential, positive));
+			__m512i negative_reset = _mm512_mask_blend_epi32(linear, _mm512_sub_epi32(_mm512_setzero_si512(), reset), _mm512_add_epi32(potential, negative));
+
+			__m512i result = _mm512_mask_blend_epi32(below_negative, potential, negative_reset);
+			result = _mm512_mask_blend_epi32(spikes, result, positive_reset);
+			_mm512_storeu_si512(current_potential + neuron, _mm512_min_epi32(_mm512_max_epi32(result, lower), upper));
+
+			fired[neuron / BitWord::BITS_PER_WORD] |= (uint64_t)spikes << (neuron % BitWord::BITS_PER_WORD);
+		}
+		leakAndFireScalar(neuron, num_neurons, current_potential, leak, positive_threshold, negative_threshold, reset_potential, reset_mode, min_potential, max_potential, fired);
+	}
+
+	// 32 neurons per iteration, using the AVX-512BW 16-bit operations.
+	template <int NUM_NEURONS>
+	__attribute__((target("avx512f,avx512bw")))
+	static void leakAndFireAVX512(int num_neurons, int16_t* current_potential, const int16_t* leak, const int16_t* positive_threshold, const int16_t* negative_threshold, const int16_t* reset_potential, const int16_t* reset_mode, int min_potential, int max_potential, uint64_t* fired) {
+		if (NUM_NEURONS) {
+			num_neurons = NUM_NEURONS;
+		}
+		const __m512i one = _mm512_set1_epi16(1);
+		const __m512i lower = _mm512_set1_epi16(min_potential);
+		const __m512i upper = _mm512_set1_epi16(max_potential);
+		int neuron = 0;
+		for (; neuron + 32 <= num_neurons; neuron += 32) {
+			__m512i potential = _mm512_adds_epi16(_mm512_loadu_si512(current_potential + neuron), _mm512_loadu_si512(leak + neuron));
+			potential = _mm512_min_epi16(_mm512_max_epi16(potential, lower), upper);
+			__m512i positive = _mm512_loadu_si512(positive_threshold + neuron);
+			__m512i negative = _mm512_loadu_si512(negative_threshold + neuron);
+			__m512i reset = _mm512_loadu_si512(reset_potential + neuron);
+			__mmask32 linear = _mm512_cmpeq_epi16_mask(_mm512_loadu_si512(reset_mode + neuron), one);
+
+			__mmask32 spikes = _mm512_cmpge_epi16_mask(potential, positive);
+			__mmask32 below_negative = _mm512_cmplt_epi16_mask(potential, negative);
+
+			__m512i positive_reset = _mm512_mask_blend_epi16(linear, reset, _mm512_subs_epi16(potential, positive));
+			__m512i negative_reset = _mm512_mask_blend_epi16(linear, _mm512_subs_epi16(_mm512_setzero_si512(), reset), _mm512_adds_epi16(potential, negative));
+
+			__m512i result = _mm512_mask_blend_epi16(below_negative, potential, negative_reset);
+			result = _mm512_mask_blend_epi16(spikes, result, positive_reset);
+			_mm512_storeu_si512(current_potential + neuron, _mm512_min_epi16(_mm512_max_epi16(result, lower), upper));
+
+			fired[neuron / BitWord::BITS_PER_WORD] |= (uint64_t)spikes << (neuron % BitWord::BITS_PER_WORD);
+		}
+		leakAndFireScalar(neuron, num_neurons, current_potential, leak, positive_threshold, negative_threshold, reset_potential, reset_mode, min_potential, max_potential, fired);
+	}
+
+	// Expands each byte of the neuron mask into 8 all-ones or all-zeros lanes.
+	template <int NUM_NEURONS>
+	__attribute__((target("avx2")))
+	static void addMaskedWeightsAVX2(int num_neurons, int32_t* current_potential, const int32_t* weights, const uint64_t* neurons, int min_potential, int max_potential) {
+		if (NUM_NEURONS) {
+			num_neurons = NUM_NEURONS;
+		}
+		const __m256i bit_select = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+		const __m256i lower = _mm256_set1_epi32(min_potential);
+		const __m256i upper = _mm256_set1_epi32(max_potential);
+		int vector_end = num_neurons - num_neurons % 8;
+		for (int word = 0; word * BitWord::BITS_PER_WORD < vector_end; word++) {
+			uint64_t bits = neurons[word];
+			for (int neuron = word * BitWord::BITS_PER_WORD; bits && neuron < vector_end; neuron += 8, bits >>= 8) {
+				if (!(bits & 0xFF)) {
+					continue;
+				}
+				__m256i selected = _mm256_and_si256(_mm256_set1_epi32(bits & 0xFF), bit_select);
+				__m256i lanes = _mm256_cmpeq_epi32(selected, bit_select);
+				__m256i potential = _mm256_loadu_si256((const __m256i*)(current_potential + neuron));
+				__m256i weight = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(weights + neuron)), lanes);
+				potential = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(potential, weight), lower), upper);
+				_mm256_storeu_si256((__m256i*)(current_potential + neuron), potential);
+			}
+		}
+		addMaskedWeightsScalar(vector_end, num_neurons, current_potential, weights, neurons, min_potential, max_potential);
+	}
+
+	// Expands each 16 bits of the neuron mask into 16 all-ones or all-zeros lanes.
+	template <int NUM_NEURONS>
+	__attribute__((target("avx2")))
+	static void addMaskedWeightsAVX2(int num_neurons, int16_t* current_potential, const int16_t* weights, const uint64_t* neurons, int min_potential, int max_potential) {
+		if (NUM_NEURONS) {
+			num_neurons = NUM_NEURONS;
+		}
+		const __m256i bit_select = _mm256_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, -32768);
+		const __m256i lower = _mm256_set1_epi16(min_potential);
+		const __m256i upper = _mm256_set1_epi16(max_potential);
+		int vector_end = num_neurons - num_neurons % 16;
+		for (int word = 0; word * BitWord::BITS_PER_WORD < vector_end; word++) {
+			uint64_t bits = neurons[word];
+			for (int neuron = word * BitWord::BITS_PER_WORD; bits && neuron < vector_end; neuron += 16, bits >>= 16) {
+				if (!(bits & 0xFFFF)) {
+					continue;
+				}
+				__m256i selected = _mm256_and_si256(_mm256_set1_epi16(bits & 0xFFFF), bit_select);
+				__m256i lanes = _mm256_cmpeq_epi16(selected, bit_select);
+				__m256i potential = _mm256_loadu_si256((const __m256i*)(current_potential + neuron));
+				__m256i weight = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(weights + neuron)), lanes);
+				potential = _mm256_min_epi16(_mm256_max_epi16(_mm256_adds_epi16(potential, weight), lower), upper);
+				_mm256_storeu_si256((__m256i*)(current_potential + neuron), potential);
+			}
+		}
+		addMaskedWeightsScalar(vector_end, num_neurons, current_potential, weights, neurons, min_potential, max_potential);
+	}
+
+	// Each 16 bits of the neuron mask is used directly as the write mask of a masked add.
+	template <int NUM_NEURONS>
+	__attribute__((target("avx512f")))
+	static void addMaskedWeightsAVX512(int num_neurons, int32_t* current_potential, const int32_t* weights, const uint64_t* neurons, int min_potential, int max_potential) {
+		if (NUM_NEURONS) {
+			num_neurons = NUM_NEURONS;
+		}
+		const __m512i lower = _mm512_set1_epi32(min_potential);
+		const __m512i upper = _mm512_set1_epi32(max_potential);
+		int vector_end = num_neurons - num_neurons % 16;
+		for (int word = 0; word * BitWord::BITS_PER_WORD < vector_end; word++) {
+			uint64_t bits = neurons[word];
+			for (int neuron = word * BitWord::BITS_PER_WORD; bits && neuron < vector_end; neuron += 16, bits >>= 16) {
+				__mmask16 lanes = bits & 0xFFFF;
+				if (!lanes) {
+					continue;
+				}
+				__m512i potential = _mm512_loadu_si512(current_potential + neuron);
+				potential = _mm512_mask_add_epi32(potential, lanes, potential, _mm512_maskz_loadu_epi32(lanes, weights + neuron));
+				_mm512_storeu_si512(current_potential + neuron, _mm512_min_epi32(_mm512_max_epi32(potential, lower), upper));
+			}
+		}
+		addMaskedWeightsScalar(vector_end, num_neurons, current_potential, weights, neurons, min_potential, max_potential);
+	}
+
+	// Each 32 bits of the neuron mask is used directly as the write mask of a masked saturating add.
+	template <int NUM_NEURONS>
+	__attribute__((target("avx512f,avx512bw")))
+	static void addMaskedWeightsAVX512(int num_neurons, int16_t* current_potential, const int16_t* weights, const uint64_t* neurons, int min_potential, int max_potential) {
+		if (NUM_NEURONS) {
+			num_neurons = NUM_NEURONS;
+		}
+		const __m512i lower = _mm512_set1_epi16(min_potential);
+		const __m512i upper = _mm512_set1_epi16(max_potential);
+		int vector_end = num_neurons - num_neurons % 32;
+		for (int word = 0; word * BitWord::BITS_PER_WORD < vector_end; word++) {
+			uint64_t bits = neurons[word];
+			for (int neuron = word * BitWord::BITS_PER_WORD; bits && neuron < vector_end; neuron += 32, bits >>= 32) {
+				__mmask32 lanes = bits & 0xFFFFFFFF;
+				if (!lanes) {
+					continue;
+				}
+				__m512i potential = _mm512_loadu_si512(current_potential + neuron);
+				potential = _mm512_mask_adds_epi16(potential, lanes, potential, _mm512_maskz_loadu_epi16(lanes, weights + neuron));
+				_mm512_storeu_si512(current_potential + neuron, _mm512_min_epi16(_mm512_max_epi16(potential, lower), upper));
+			}
+		}
+		addMaskedWeightsScalar(vector_end, num_neurons, current_potential, weights, neurons, min_potential, max_potential);
+	}
+#endif
+
+	enum InstructionSet { SCALAR, AVX2, AVX512 };
+
+	struct Implementation {
+		std::string name;
+		InstructionSet instruction_set;
+	};
+
+	static bool supported(std::string name) {
+		if (name == "scalar") {
+			return true;
+		}
+#ifdef NEURON_KERNEL_X86
+		__builtin_cpu_init();
+		if (name == "avx2") {
+			return __builtin_cpu_supports("avx2");
+		}
+		if (name == "avx512") {
+			return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+		}
+#endif
+		return false;
+	}
+
+	static Implementation implementation(std::string name) {
+		Implementation result = {"scalar", SCALAR};
+		if (name == "avx2") {
+			result = {"avx2", AVX2};
+		} else if (name == "avx512") {
+			result = {"avx512", AVX512};
+		}
+		return result;
+	}
+
+	static Implementation best() {
+		if (supported("avx512")) {
+			return implementation("avx512");
+		}
+		if (supported("avx2")) {
+			return implementation("avx2");
+		}
+		return implementation("scalar");
+	}
+
+	static Implementation current = best();
+
+	// Each instantiation dispatches to its own specializations of the kernels, so the instruction set
+	// is switched on rather than stored as function pointers.
+	template <typename Lane, int NUM_NEURONS>
+	void leakAndFire(int num_neurons, Lane* current_potential, const Lane* leak, const Lane* positive_threshold, const Lane* negative_threshold, const Lane* reset_potential, const Lane* reset_mode, int min_potential, int max_potential, uint64_t* fired) {
+		std::fill(fired, fired + BitWord::numWords(NUM_NEURONS ? NUM_NEURONS : num_neurons), 0);
+		switch (current.instruction_set) {
+#ifdef NEURON_KERNEL_X86
+			case AVX512:
+				leakAndFireAVX512<NUM_NEURONS>(num_neurons, current_potential, leak, positive_threshold, negative_threshold, reset_potential, reset_mode, min_potential, max_potential, fired);
+				break;
+			case AVX2:
+				leakAndFireAVX2<NUM_NEURONS>(num_neurons, current_potential, leak, positive_threshold, negative_threshold, reset_potential, reset_mode, min_potential, max_potential, fired);
+				break;
+#endif
+			default:
+				leakAndFireScalar<NUM_NEURONS>(num_neurons, current_potential, leak, positive_threshold, negative_threshold, reset_potential, reset_mode, min_potential, max_potential, fired);
+		}
+	}
+
+	template <typename Lane, int NUM_NEURONS>
+	void addMaskedWeights(int num_neurons, Lane* current_potential, const Lane* weights, const uint64_t* neurons, int min_potential, int max_potential) {
+		switch (current.instruction_set) {
+#ifdef NEURON_KERNEL_X86
+			case AVX512:
+				addMaskedWeightsAVX512<NUM_NEURONS>(num_neurons, current_potential, weights, neurons, min_potential, max_potential);
+				break;
+			case AVX2:
+				addMaskedWeightsAVX2<NUM_NEURONS>(num_neurons, current_potential, weights, neurons, min_potential, max_potential);
+				break;
+#endif
+			default:
+				addMaskedWeightsScalar<NUM_NEURONS>(num_neurons, current_potential, weights, neurons, min_potential, max_potential);
+		}
+	}
+
+#define INSTANTIATE_NEURON_KERNELS(Lane, NUM_NEURONS) \
+	template void leakAndFire<Lane, NUM_NEURONS>(int, Lane*, const Lane*, const Lane*, const Lane*, const Lane*, const Lane*, int, int, uint64_t*); \
+	template void addMaskedWeights<Lane, NUM_NEURONS>(int, Lane*, const Lane*, const uint64_t*, int, int);
+
+	// The generic kernels and the neuron counts of CoreKernel's specialized geometries
+	INSTANTIATE_NEURON_KERNELS(int16_t, 0)
+	INSTANTIATE_NEURON_KERNELS(int16_t, 64)
+	INSTANTIATE_NEURON_KERNELS(int16_t, 128)
+	INSTANTIATE_NEURON_KERNELS(int16_t, 256)
+	INSTANTIATE_NEURON_KERNELS(int16_t, 512)
+	INSTANTIATE_NEURON_KERNELS(int32_t, 0)
+	INSTANTIATE_NEURON_KERNELS(int32_t, 64)
+	INSTANTIATE_NEURON_KERNELS(int32_t, 128)
+	INSTANTIATE_NEURON_KERNELS(int32_t, 256)
+	INSTANTIATE_NEURON_KERNELS(int32_t, 512)
+
+	bool select(std::string name) {
+		if (name == "auto") {
+			current = best();
+			return true;
+		}
+		if (!supported(name)) {
+			return false;
+		}
+		current = implementation(name);
+		return true;
+	}
+
+	std::string selected() {
+		return current.name;
+	}
+}
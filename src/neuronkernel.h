@@ -0,0 +1,63 @@
+/// neuronkernel.h
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#ifndef NEURONKERNEL_H
+#define NEURONKERNEL_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Vectorized neuron block operations over every neuron of a core.
+ * 
+ * Each operation has a scalar implementation and, on x86, AVX2 and AVX-512
+ * implementations compiled with function-level target attributes. The widest
+ * one the CPU supports is selected at startup; `select` can force a narrower
+ * one. All implementations produce bit-identical results.
+ * 
+ * The kernels are templates on the number of neurons so that a core geometry
+ * known at compile time gets fixed trip counts and no scalar tail. NUM_NEURONS
+ * is either num_neurons or 0 for any number of neurons; it is instantiated for
+ * 0 and for the neuron counts of CoreKernel's specialized geometries. They are
+ * also templates on the lane type, int16_t or int32_t, of the neuron state
+ * (see LaneVector).
+ * 
+ * Every step that changes a potential saturates it at [min_potential,
+ * max_potential], which must lie within the lane type.
+ */
+namespace NeuronKernel {
+
+	/**
+	 * @brief Applies leak, checks both thresholds and resets every neuron.
+	 * 
+	 * Equivalent to calling NeuronBlock::leak, NeuronBlock::spikes and
+	 * NeuronBlock::output_potential for each neuron in turn. Bit `i` of `fired`
+	 * is set when neuron `i` spikes; `fired` must hold numWords(num_neurons)
+	 * words and is overwritten. Reset modes other than 1 are treated as 0, so
+	 * they must be validated when the CSRAM is loaded.
+	 */
+	template <typename Lane, int NUM_NEURONS>
+	void leakAndFire(int num_neurons, Lane* current_potential, const Lane* leak, const Lane* positive_threshold, const Lane* negative_threshold, const Lane* reset_potential, const Lane* reset_mode, int min_potential, int max_potential, uint64_t* fired);
+
+	/**
+	 * @brief Adds `weights[i]` to `current_potential[i]` for every neuron `i` set in `neurons`.
+	 * 
+	 * Used to integrate one spiking axon into every neuron connected to it, where
+	 * `neurons` is the axon's column of the crossbar and `weights` holds each
+	 * neuron's weight for the axon's type.
+	 */
+	template <typename Lane, int NUM_NEURONS>
+	void addMaskedWeights(int num_neurons, Lane* current_potential, const Lane* weights, const uint64_t* neurons, int min_potential, int max_potential);
+
+	// Selects the implementation to use: "auto", "scalar", "avx2" or "avx512".
+	// Returns false if the name is unknown or the CPU does not support it.
+	bool select(std::string name);
+
+	// Name of the implementation in use.
+	std::string selected();
+}
+
+#endif // NEURONKERNEL_H
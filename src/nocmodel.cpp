@@ -0,0 +1,176 @@
+/// nocmodel.cpp
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#include "nocmodel.h"
+
+NocModel::NocModel(int num_cores_x, int num_cores_y, int fifo_depth, int cycles_per_tick) {
+	this->num_cores_x = num_cores_x;
+	this->num_routers = num_cores_x * num_cores_y;
+	this->fifo_depth = fifo_depth;
+	this->cycles_per_tick = cycles_per_tick;
+
+	packets = 0;
+	late_packets = 0;
+	stalled_packets = 0;
+	stall_cycles = 0;
+	max_cycles = 0;
+	busiest_tick = -1;
+
+	fifo = std::vector<int>(num_routers * NUM_PORTS * fifo_depth);
+	fifo_head = std::vector<int>(num_routers * NUM_PORTS);
+	fifo_count = std::vector<int>(num_routers * NUM_PORTS);
+	round_robin = std::vector<int>(num_routers);
+	router_active = std::vector<bool>(num_routers);
+}
+
+void NocModel::addPacket(int x, int y, int dx, int dy) {
+	packet_router.push_back(x + y * num_cores_x);
+	packet_dx.push_back(dx);
+	packet_dy.push_back(dy);
+}
+
+// Dimension-order routing moves a packet along x until it is in the right column, then along y.
+NocModel::Port NocModel::outputPort(int packet) {
+	if (packet_dx[packet] != 0) {
+		return packet_dx[packet] > 0 ? EAST : WEST;
+	}
+	if (packet_dy[packet] != 0) {
+		return packet_dy[packet] > 0 ? NORTH : SOUTH;
+	}
+	return LOCAL;
+}
+
+void NocModel::activate(int router) {
+	if (!router_active[router]) {
+		router_active[router] = true;
+		active_routers.push_back(router);
+	}
+}
+
+void NocModel::push(int fifo_index, int packet) {
+	fifo[fifo_index * fifo_depth + (fifo_head[fifo_index] + fifo_count[fifo_index]) % fifo_depth] = packet;
+	fifo_count[fifo_index]++;
+}
+
+int NocModel::pop(int fifo_index) {
+	int packet = fifo[fifo_index * fifo_depth + fifo_head[fifo_index]];
+	fifo_head[fifo_index] = (fifo_head[fifo_index] + 1) % fifo_depth;
+	fifo_count[fifo_index]--;
+	return packet;
+}
+
+void NocModel::endTick(int tick) {
+	int num_packets = packet_router.size();
+	if (num_packets == 0) {
+		return;
+	}
+
+	// Group the packets by source router with a counting sort, keeping the order they were sent in
+	injection_next.assign(num_routers + 1, 0);
+	for (int packet = 0; packet < num_packets; packet++) {
+		injection_next[packet_router[packet] + 1]++;
+	}
+	for (int router = 0; router < num_routers; router++) {
+		injection_next[router + 1] += injection_next[router];
+	}
+	injection_end = injection_next;
+	injection.resize(num_packets);
+	for (int packet = 0; packet < num_packets; packet++) {
+		injection[injection_end[packet_router[packet]]++] = packet;
+		activate(packet_router[packet]);
+	}
+	packet_stalled.assign(num_packets, false);
+
+	// Where a packet leaving through each port goes, as a change of router index and the input port it arrives at
+	const int router_step[] = {num_cores_x, -num_cores_x, 1, -1};
+	const Port arrival_port[] = {SOUTH, NORTH, WEST, EAST};
+
+	int cycle = 0;
+	int delivered = 0;
+	while (delivered < num_packets) {
+		cycle++;
+
+		// Pick the packets that move on this cycle from the state at its start
+		moves.clear();
+		for (int router : active_routers) {
+			int base = router * NUM_PORTS;
+			bool port_used[NUM_PORTS] = {false, false, false, false, false};
+			for (int i = 0; i < NUM_PORTS; i++) {
+				int from = (round_robin[router] + i) % NUM_PORTS;
+				if (fifo_count[base + from] == 0) {
+					continue;
+				}
+				int packet = fifo[(base + from) * fifo_depth + fifo_head[base + from]];
+				Port port = outputPort(packet);
+				if (!port_used[port] && (port == LOCAL || fifo_count[(router + router_step[port]) * NUM_PORTS + arrival_port[port]] < fifo_depth)) {
+					port_used[port] = true;
+					Move move = {router, from, port};
+					moves.push_back(move);
+				} else {
+					stall_cycles++;
+					if (!packet_stalled[packet]) {
+						packet_stalled[packet] = true;
+						stalled_packets++;
+					}
+				}
+			}
+			round_robin[router] = (round_robin[router] + 1) % NUM_PORTS;
+
+			if (injection_next[router] < injection_end[router] && fifo_count[base + LOCAL] < fifo_depth) {
+				Move move = {router, -1, LOCAL};
+				moves.push_back(move);
+			}
+		}
+
+		for (const Move& move : moves) {
+			if (move.from < 0) {
+				push(move.router * NUM_PORTS + LOCAL, injection[injection_next[move.router]++]);
+				continue;
+			}
+			int packet = pop(move.router * NUM_PORTS + move.from);
+			if (move.port == LOCAL) {
+				delivered++;
+				if (cycle > cycles_per_tick) {
+					late_packets++;
+				}
+				continue;
+			}
+			if (move.port == EAST || move.port == WEST) {
+				packet_dx[packet] += move.port == EAST ? -1 : 1;
+			} else {
+				packet_dy[packet] += move.port == NORTH ? -1 : 1;
+			}
+			int next_router = move.router + router_step[move.port];
+			push(next_router * NUM_PORTS + arrival_port[move.port], packet);
+			activate(next_router);
+		}
+
+		// Keep the routers that still hold packets
+		next_active_routers.clear();
+		for (int router : active_routers) {
+			bool busy = injection_next[router] < injection_end[router];
+			for (int port = 0; port < NUM_PORTS && !busy; port++) {
+				busy = fifo_count[router * NUM_PORTS + port] > 0;
+			}
+			if (busy) {
+				next_active_routers.push_back(router);
+			} else {
+				router_active[router] = false;
+			}
+		}
+		active_routers.swap(next_active_routers);
+	}
+
+	packets += num_packets;
+	if (cycle > max_cycles) {
+		max_cycles = cycle;
+		busiest_tick = tick;
+	}
+
+	packet_router.clear();
+	packet_dx.clear();
+	packet_dy.clear();
+}
@@ -0,0 +1,96 @@
+/// nocmodel.h
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#ifndef NOCMODEL_H
+#define NOCMODEL_H
+
+#include <vector>
+
+/**
+ * @brief A cycle-approximate model of contention on the mesh.
+ * 
+ * The packets sent during a tick are replayed through the mesh one cycle at a
+ * time after every core has run. Each router has a bounded FIFO on each of its
+ * north, south, east, west and local input ports. On every cycle each output
+ * link of a router carries at most one packet, taken from the head of an input
+ * FIFO that routes to it, and only if the FIFO it leads to had room at the
+ * start of the cycle. Input ports are served round robin. A core injects its
+ * packets into its local FIFO in the order they were sent, and a packet leaves
+ * the mesh at its destination through the local output, one per cycle.
+ * 
+ * A packet that could not move because it lost arbitration or the next FIFO
+ * was full stalls for that cycle, and a packet delivered after
+ * `cycles_per_tick` cycles is late. Each tick starts from an empty mesh, and the
+ * model only measures the traffic: spikes are still delivered on time. FIFOs
+ * and packets are kept in flat arrays, and only routers holding packets are
+ * visited on each cycle.
+ */
+class NocModel {
+	public:
+		NocModel(int num_cores_x, int num_cores_y, int fifo_depth, int cycles_per_tick);
+
+		// Adds a packet sent from core (`x`, `y`) to the core `dx`, `dy` away during the current tick
+		void addPacket(int x, int y, int dx, int dy);
+		// Replays the packets of `tick` through the mesh
+		void endTick(int tick);
+
+		int fifo_depth;
+		int cycles_per_tick;
+
+		// Totals over every tick
+		long long packets;
+		long long late_packets;
+		long long stalled_packets;
+		long long stall_cycles;
+		// The most cycles any tick took to deliver all of its packets, and that tick
+		int max_cycles;
+		int busiest_tick;
+
+	private:
+		enum Port { NORTH, SOUTH, EAST, WEST, LOCAL, NUM_PORTS };
+
+		Port outputPort(int packet);
+		void activate(int router);
+		void push(int fifo_index, int packet);
+		int pop(int fifo_index);
+
+		int num_cores_x;
+		int num_routers;
+
+		// The packets of the current tick: where they are, how far they still have to go and whether
+		// they have stalled
+		std::vector<int> packet_router;
+		std::vector<int> packet_dx;
+		std::vector<int> packet_dy;
+		std::vector<bool> packet_stalled;
+
+		// Packets waiting to be injected, grouped by source router, and where each router's group starts
+		std::vector<int> injection;
+		std::vector<int> injection_next;
+		std::vector<int> injection_end;
+
+		// A ring of `fifo_depth` packets for each input port of each router, indexed by router * NUM_PORTS + port
+		std::vector<int> fifo;
+		std::vector<int> fifo_head;
+		std::vector<int> fifo_count;
+		// The input port each router serves first on the next cycle
+		std::vector<int> round_robin;
+
+		// Routers holding packets, and the ones still holding packets after a cycle
+		std::vector<int> active_routers;
+		std::vector<int> next_active_routers;
+		std::vector<bool> router_active;
+
+		// A packet moving on this cycle, from the input `from` (or injected if -1) to `port` of its router
+		struct Move {
+			int router;
+			int from;
+			Port port;
+		};
+		std::vector<Move> moves;
+};
+
+#endif // NOCMODEL_H
@@ -4,11 +4,14 @@
 ///
 ///
 
+#include <cstdlib>
+#include <algorithm>
+
 #include "router.h"
 #include "core.h"
 #include "scheduler.h"
-
-// TODO: I can't think of a use for this now, but it may be useful at some point to have trace output for the router.
+#include "linkcounters.h"
+#include "nocmodel.h"
 
 Router::Router(Core* parent, Router* north, Router* south, Router* west, Router* east) {
 	this->parent = parent;
@@ -18,7 +21,33 @@ Router::Router(Core* parent, Router* north, Router* south, Router* west, Router*
 	this->east = east;
 }
 
+Router::RoutingMode Router::routing_mode = Router::DIRECT;
+bool Router::record_statistics = false;
+Router::Statistics Router::statistics = {0, 0, 0};
+LinkCounters* Router::link_counters = NULL;
+NocModel* Router::noc_model = NULL;
+
+void Router::recordRoute(int x, int y, int dx, int dy) {
+	if (record_statistics) {
+		// Dimension-order routing takes one hop per core crossed in each direction
+		int hops = std::abs(dx) + std::abs(dy);
+		statistics.packets++;
+		statistics.hops += hops;
+		statistics.max_hops = std::max(statistics.max_hops, hops);
+	}
+	if (link_counters != NULL) {
+		link_counters->recordRoute(x, y, dx, dy);
+	}
+	if (noc_model != NULL) {
+		noc_model->addPacket(x, y, dx, dy);
+	}
+}
+
 void Router::receiveLocal(Packet packet) {
+	if (recordsRoutes()) {
+		recordRoute(parent->x, parent->y, packet.dx, packet.dy);
+	}
+
 	if (packet.dx < 0) {
 		receiveLocalOrEast(packet);
 	} else {
@@ -8,6 +8,8 @@
 #define ROUTER_H
 
 class Core;
+class LinkCounters;
+class NocModel;
 
 // User Defined Headers
 #include"packet.h"
@@ -15,11 +17,42 @@ class Core;
 /**
  * @brief Routes packets between cores.
  * 
+ * In MESH mode a packet is passed from router to router, first along x and
+ * then along y, until it reaches its destination core. In DIRECT mode the
+ * token controllers skip the routers and write their neurons' spikes straight
+ * into the schedulers of the destination cores, which are resolved when the
+ * input is decoded. Dimension-order routing always reaches that core, so both
+ * modes deliver the same packets. Input packets are always written straight
+ * into their destination's scheduler.
+ * 
+ * CONTENTION mode delivers spikes as DIRECT mode does, and also replays the
+ * packets of every tick through a NocModel of the mesh's links and FIFOs.
  */
 class Router{
 	public:
 		Router(Core* parent, Router* north, Router* south, Router* west, Router* east);		
 
+		enum RoutingMode { MESH, DIRECT, CONTENTION };
+		static RoutingMode routing_mode;
+
+		// Totals over every packet sent by a core or input, when `record_statistics` is set
+		struct Statistics {
+			long long packets;
+			long long hops;
+			int max_hops;
+		};
+		static bool record_statistics;
+		static Statistics statistics;
+		// Traffic on each link of the mesh, if set
+		static LinkCounters* link_counters;
+		// Contention on the mesh, set in CONTENTION mode
+		static NocModel* noc_model;
+
+		// Whether packets are counted in `statistics`, `link_counters` or `noc_model`
+		static bool recordsRoutes() { return record_statistics || link_counters != 0 || noc_model != 0; }
+		// Counts a packet sent from core (`x`, `y`) to the core `dx`, `dy` away
+		static void recordRoute(int x, int y, int dx, int dy);
+
 		// Receive Functions
 		void receiveLocal(Packet packet);
 		void receiveWest(Packet packet);
@@ -44,11 +77,12 @@ class Router{
 
 		// The Core that this router belongs to
 		Core *parent;		
-		
+
 		// The routers north, south, east, and west of this core.
 		Router *north;
 		Router *south;
 		Router *east;
 		Router *west;
+
 };
 #endif
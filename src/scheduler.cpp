@@ -4,30 +4,168 @@
 ///
 ///
 
+#include <iostream>
+#include <sstream>
+
+#include <plog/Log.h>
+
 #include "scheduler.h"
 #include "schedulersram.h"
+#include "schedulerwheel.h"
+#include "coreworklist.h"
+#include "bitword.hpp"
+#include "config.hpp"
+
+// AUTO uses the wheel for cores that at most one in this many axons can receive a spike on
+static const int SPARSE_AXONS_PER_SPIKE = 16;
+
+Scheduler::Storage Scheduler::storage = Scheduler::AUTO;
+Scheduler::Warnings Scheduler::total_warnings = {0, 0};
+int Scheduler::warning_samples = 10;
+bool Scheduler::strict_warnings = false;
+bool Scheduler::concurrent_writes = false;
+bool Scheduler::shared_writes = false;
 
 Scheduler::Scheduler(Core* parent) {
 	this->parent = parent;
-	this->sram = new SchedulerSRAM(this);
+	this->sram = NULL;
+	this->wheel = NULL;
+	this->worklist = NULL;
+	this->fan_in = 0;
+	this->warnings.current_word = 0;
+	this->warnings.duplicate = 0;
+	// Packets received before the first tick are relative to the tick before it
+	this->curr_tick = -1;
+}
+
+void Scheduler::chooseStorage(int fan_in) {
+	bool sparse = storage == SPARSE || (storage == AUTO && fan_in * SPARSE_AXONS_PER_SPIKE <= Config::parameters.num_axons);
+	if (sparse) {
+		wheel = new SchedulerWheel();
+	} else {
+		sram = new SchedulerSRAM();
+	}
 }
 
-// Receives a packet and writes it to the `sram`.
+void Scheduler::relocate() {
+	if (wheel != NULL) {
+		SchedulerWheel* local_wheel = new SchedulerWheel(*wheel);
+		delete wheel;
+		wheel = local_wheel;
+	} else {
+		SchedulerSRAM* local_sram = new SchedulerSRAM(*sram);
+		delete sram;
+		sram = local_sram;
+	}
+}
+
+// Receives a packet and writes its spike to storage.
 void Scheduler::receivePacket(Packet packet) {
-	sram->write(packet.delivery_tick , packet.destination_axon); 
+	receiveSpike(packet.delivery_tick, packet.destination_axon);
 }
 
-// Returns the spikes from the `sram` for the current word.
-std::vector<bool> Scheduler::getSpikes() {	
-	return sram->getCurrentWord();
+// Writes a spike for `destination_axon` to storage, `delivery_tick` ticks from now.
+void Scheduler::receiveSpike(int delivery_tick, int destination_axon) {
+	if (worklist != NULL) {
+		worklist->wake(parent);
+	}
+
+	// Increment word so that it is not written to current timestep
+	int ticks_ahead = delivery_tick + 1;
+
+	if (ticks_ahead >= Config::parameters.max_tick_offset) {
+		warnCurrentWord(SchedulerSRAM::hardwareWord(curr_tick));
+	} else if (!(wheel != NULL ? wheel->write(ticks_ahead, destination_axon) : shared_writes ? sram->writeShared(ticks_ahead, destination_axon) : sram->write(ticks_ahead, destination_axon))) {
+		warnDuplicate(SchedulerSRAM::hardwareWord(curr_tick + ticks_ahead));
+	} else if (Config::parameters.scheduler_trace_verbosity == 2) {
+		LOG_DEBUG_(1) << "~~~ Scheduler (" << parent->x << ", " << parent->y << ") writes to word " << SchedulerSRAM::hardwareWord(curr_tick + ticks_ahead) << ", bit " << destination_axon << " ~~~";
+	}
 }
 
-// Clears the `sram`.
+void Scheduler::warnCurrentWord(int word) {
+	if (shared_writes) {
+		__atomic_fetch_add(&warnings.current_word, 1, __ATOMIC_RELAXED);
+		return;
+	}
+	warnings.current_word++;
+	if (concurrent_writes) {
+		return;
+	}
+	total_warnings.current_word++;
+	if (Config::traceSpecified()) {
+		LOG_DEBUG_(1) << "[WARNING] Packet tried to write to current word in scheduler (core (" << parent->x << ", " << parent->y << ")" << ", word " << word << ")" << std::endl;
+	}
+	bool sampled = total_warnings.current_word + total_warnings.duplicate <= warning_samples;
+	if (strict_warnings || sampled) {
+		std::string message = "Packet tried to write to current word in scheduler (core (" + std::to_string(parent->x) + ", " + std::to_string(parent->y) + "), word " + std::to_string(word) + ")";
+		if (strict_warnings) {
+			throw SchedulerWarningException(message);
+		}
+		std::cout << "[WARNING] " << message << "\n";
+	}
+}
+
+void Scheduler::warnDuplicate(int word) {
+	if (shared_writes) {
+		__atomic_fetch_add(&warnings.duplicate, 1, __ATOMIC_RELAXED);
+		return;
+	}
+	warnings.duplicate++;
+	if (concurrent_writes) {
+		return;
+	}
+	total_warnings.duplicate++;
+	if (Config::traceSpecified()) {
+		LOG_DEBUG_(1) << "[WARNING] Scheduler received duplicate spike in same time tick (core (" << parent->x << ", " << parent->y << ") word " << word << ").";
+	}
+	bool sampled = total_warnings.current_word + total_warnings.duplicate <= warning_samples;
+	if (strict_warnings || sampled) {
+		std::string message = "Scheduler received duplicate spike in same time tick (core (" + std::to_string(parent->x) + ", " + std::to_string(parent->y) + "), word " + std::to_string(word) + ").";
+		if (strict_warnings) {
+			throw SchedulerWarningException(message);
+		}
+		std::cout << "[WARNING] " << message << "\n";
+	}
+}
+
+// Returns the spikes of the current word.
+const uint64_t* Scheduler::getSpikes() {	
+	return wheel != NULL ? wheel->getCurrentWord() : sram->getCurrentWord();
+}
+
+// Clears the current word.
 void Scheduler::clear() {
-	sram->clearCurrentWord();
+	if (wheel != NULL) {
+		wheel->clearCurrentWord();
+	} else {
+		sram->clearCurrentWord();
+	}
+}
+
+// Updates the current word to the word for `tick`.
+void Scheduler::updateCurrentWord(int tick){
+	curr_tick = tick;
+	if (wheel != NULL) {
+		wheel->updateCurrentWord(tick);
+	} else {
+		sram->updateCurrentWord(tick);
+	}
+
+	if (Config::parameters.scheduler_trace_verbosity) {
+		std::ostringstream temp;
+		for (int axon = 0; axon < Config::parameters.num_axons; axon++) {
+			temp << BitWord::test(getSpikes(), axon);
+		}
+		LOG_DEBUG_(1) << "~~~ Scheduler (" << parent->x << ", " << parent->y << ") updates current word to " << SchedulerSRAM::hardwareWord(curr_tick) << ". Current line: " << temp.str();
+	}
+}
+
+// Returns whether storage holds spikes for the current word.
+bool Scheduler::hasCurrentSpikes() {
+	return (wheel != NULL ? wheel->currentWordPending() : sram->currentWordPending()) > 0;
 }
 
-// Updates the current word in the `sram`.
-void Scheduler::updateCurrentWord(){
-	sram->updateCurrentWord();
+// Returns whether storage holds spikes for any word.
+bool Scheduler::hasPendingSpikes() {
+	return (wheel != NULL ? wheel->pending() : sram->pending()) > 0;
 }
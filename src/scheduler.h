@@ -8,21 +8,96 @@
 #define SCHEDULER_H
 
 class SchedulerSRAM;
+class SchedulerWheel;
+class CoreWorklist;
+
+#include <cstdint>
+#include <string>
+#include <exception>
 
 #include "packet.h"
 #include "core.h"
 
+// Thrown when a scheduler drops a spike while `Scheduler::strict_warnings` is set
+class SchedulerWarningException : public std::exception {
+	public:
+		std::string message;
+
+		SchedulerWarningException(std::string message) {
+			this->message = message;
+		}
+
+		virtual const char* what() const throw () {
+			return message.c_str();
+		}
+};
+
+/**
+ * @brief Holds the spikes a core's axons will receive until their tick comes.
+ * 
+ * Spikes are stored either in a dense SchedulerSRAM, a bitmap of every axon
+ * for every tick, or in a sparse SchedulerWheel, which lists the axons that
+ * received a spike for each tick. Both behave identically. With AUTO storage
+ * a core uses the wheel when only a few neurons and input packets can send it
+ * spikes, which is decided by chooseStorage once the network is loaded.
+ * 
+ * Spikes for the current tick and duplicate spikes are dropped. Each drop is
+ * counted in the scheduler's `warnings`, and only the first `warning_samples`
+ * drops of the run are printed as they happen.
+ */
 class Scheduler {
 	public:
 		Scheduler(Core* parent);
 
 		void receivePacket(Packet packet);
+		void receiveSpike(int delivery_tick, int destination_axon);
 		void clear();
-		void updateCurrentWord();
-		std::vector<bool> getSpikes();
+		void updateCurrentWord(int tick);
+		// The packed spikes of the current word, valid until it is cleared
+		const uint64_t* getSpikes();
+		bool hasCurrentSpikes();
+		bool hasPendingSpikes();
 		Core* parent;
+		// Woken before each packet is written, if set
+		CoreWorklist* worklist;
+
+		enum Storage { AUTO, DENSE, SPARSE };
+		static Storage storage;
+
+		// Creates the storage for a core that at most `fan_in` spikes can be sent to per tick. Must be
+		// called once, before any spike is received.
+		void chooseStorage(int fan_in);
+		bool isSparse() { return wheel != NULL; }
+		// Copies the storage into memory allocated by the calling thread
+		void relocate();
+		// Number of neurons that can spike and send their spikes to this scheduler
+		int fan_in;
+
+		// Spikes dropped because they were for the current tick or had already been received
+		struct Warnings {
+			long long current_word;
+			long long duplicate;
+		};
+		Warnings warnings;
+		// Totals over every scheduler
+		static Warnings total_warnings;
+		// Number of warnings printed as they happen, and whether the first one ends the run
+		static int warning_samples;
+		static bool strict_warnings;
+		// Set while several threads write spikes to different schedulers at once. Drops are then only
+		// counted in each scheduler's `warnings`, and the writers add them to `total_warnings` afterwards.
+		static bool concurrent_writes;
+		// Set while several threads may write to the same dense scheduler, whose bits and counts are
+		// then updated atomically. Sparse schedulers are still written by one thread at a time.
+		static bool shared_writes;
 	private:
+		// Counts a spike dropped from `word`, only building messages when it is traced or printed
+		void warnCurrentWord(int word);
+		void warnDuplicate(int word);
+
 		SchedulerSRAM* sram;
+		SchedulerWheel* wheel;
+		int curr_tick;
 };
 
 #endif // SCHEDULER_H
@@ -4,82 +4,84 @@
 ///
 ///
 
-#include <iostream>
 #include <sstream>
-
-#include <plog/Log.h>
+#include <algorithm>
 
 #include "schedulersram.h"
+#include "bitword.hpp"
 #include "config.hpp"
 
-SchedulerSRAM::SchedulerSRAM(Scheduler* scheduler){
-	this->scheduler = scheduler;
-	data = std::vector<std::vector<bool> >(Config::parameters["max_tick_offset"].GetInt(), std::vector<bool>(Config::parameters["num_axons"].GetInt(),0));
-	curr_word_index = Config::parameters["max_tick_offset"].GetInt() - 1;
-}
-
-std::vector<bool> SchedulerSRAM::getCurrentWord(){
-	return data[curr_word_index];
+SchedulerSRAM::SchedulerSRAM(){
+	depth = 1;
+	while (depth < Config::parameters.max_tick_offset) {
+		depth *= 2;
+	}
+	mask = depth - 1;
+	num_words = BitWord::numWords(Config::parameters.num_axons);
+	data = std::vector<uint64_t>(depth * num_words);
+	word_pending = std::vector<int>(depth);
+	total_pending = 0;
+	curr_tick = -1;
 }
 
-void SchedulerSRAM::write(int word, int bit) {
-	// Increment word so that it is not written to current timestep
-	word++;
-	// Offset by current word
-	if (word + curr_word_index >= Config::parameters["max_tick_offset"].GetInt()) {
-		word += curr_word_index - Config::parameters["max_tick_offset"].GetInt();
-	} else {
-		word += curr_word_index;
+bool SchedulerSRAM::write(int ticks_ahead, int bit) {
+	int slot = (curr_tick + ticks_ahead) & mask;
+	uint64_t* words = &data[slot * num_words];
+	if (BitWord::test(words, bit)) {
+		return false;
 	}
+	BitWord::set(words, bit);
+	word_pending[slot]++;
+	total_pending++;
+	return true;
+}
 
-	if (word == curr_word_index) {
-		if (Config::traceSpecified()) {
-			LOG_DEBUG_(1) << "[WARNING] Packet tried to write to current word in scheduler (core (" << scheduler->parent->x << ", " << scheduler->parent->y << ")" << ", word " << word << ")" << std::endl;
-		}
-		std::cout << "[WARNING] Packet tried to write to current word in scheduler (core (" << scheduler->parent->x << ", " << scheduler->parent->y << ")" << ", word " << word << ")" << std::endl;
-	} else if (data[word][bit] == 1) {
-		if (Config::traceSpecified()) {
-			LOG_DEBUG_(1) << "[WARNING] Scheduler received duplicate spike in same time tick (core (" << scheduler->parent->x << ", " << scheduler->parent->y << ") word " << word << ").";
-		}
-		std::cout << "[WARNING] Scheduler received duplicate spike in same time tick (core (" << scheduler->parent->x << ", " << scheduler->parent->y << "),  word " << word << ").";
-	} else {
-		if (Config::parameters["scheduler_trace_verbosity"].GetInt() == 2) {
-			LOG_DEBUG_(1) << "~~~ Scheduler (" << scheduler->parent->x << ", " << scheduler->parent->y << ") writes to word " << word << ", bit " << bit << " ~~~";
-		}
-		data[word][bit] = 1;
+bool SchedulerSRAM::writeShared(int ticks_ahead, int bit) {
+	int slot = (curr_tick + ticks_ahead) & mask;
+	uint64_t bit_mask = (uint64_t)1 << (bit % BitWord::BITS_PER_WORD);
+	uint64_t previous = __atomic_fetch_or(&data[slot * num_words + bit / BitWord::BITS_PER_WORD], bit_mask, __ATOMIC_RELAXED);
+	if (previous & bit_mask) {
+		return false;
 	}
+	__atomic_fetch_add(&word_pending[slot], 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&total_pending, 1, __ATOMIC_RELAXED);
+	return true;
 }
 
 void SchedulerSRAM::clearCurrentWord() {
-	std::fill(data[curr_word_index].begin(), data[curr_word_index].end(), 0);
+	int slot = curr_tick & mask;
+	std::fill(data.begin() + slot * num_words, data.begin() + (slot + 1) * num_words, 0);
+	total_pending -= word_pending[slot];
+	word_pending[slot] = 0;
 }
 
-void SchedulerSRAM::updateCurrentWord() {
-	if (curr_word_index == Config::parameters["max_tick_offset"].GetInt() - 1) {
-		curr_word_index = 0;
-	} else {
-		curr_word_index++;
-	}
+// The current word is the word for `tick`, so a scheduler that has been skipped for some ticks
+// catches up in one step.
+void SchedulerSRAM::updateCurrentWord(int tick) {
+	curr_tick = tick;
+}
+
+int SchedulerSRAM::hardwareWord(int tick) {
+	int max_tick_offset = Config::parameters.max_tick_offset;
+	return (tick % max_tick_offset + max_tick_offset) % max_tick_offset;
+}
 
-	if (Config::parameters["scheduler_trace_verbosity"].GetInt()) {
-		std::ostringstream temp;
-		for (auto bit : data[curr_word_index]) {
-			temp << std::to_string(bit);
-		}
-		LOG_DEBUG_(1) << "~~~ Scheduler (" << scheduler->parent->x << ", " << scheduler->parent->y << ") updates current word to " << curr_word_index << ". Current line: " << temp.str();
+// The bits of the word in `slot`, axon 0 first.
+std::string SchedulerSRAM::wordBits(int slot) {
+	std::ostringstream temp;
+	for (int axon = 0; axon < Config::parameters.num_axons; axon++) {
+		temp << BitWord::test(&data[slot * num_words], axon);
 	}
+	return temp.str();
 }
 
 std::string SchedulerSRAM::to_string() {
 	// TODO: This function isn't going to work for large sram words. Stoi will throw an error because the line won't fit in to an int
 	std::stringstream sstream;
 
-	for (auto row : data) {
-		std::ostringstream temp;
-		for (auto bit : row) {
-			temp << std::to_string(bit);
-		}
-		sstream << std::hex << std::stoi(temp.str(), nullptr, 2);
+	// Rows in hardware order, starting from word 0, each holding the next tick it is the word for
+	for (int word = 0; word < Config::parameters.max_tick_offset; word++) {
+		sstream << std::hex << std::stoi(wordBits((curr_tick + hardwareWord(word - curr_tick)) & mask), nullptr, 2);
 		sstream << std::endl;
 	}
 
@@ -7,27 +7,56 @@
 #ifndef SCHEDULERSRAM_H
 #define SCHEDULERSRAM_H
 
+#include <cstdint>
 #include <vector>
 #include <string>
 
-#include "scheduler.h"
-
+/**
+ * @brief The spikes a core's axons will receive over the next max_tick_offset ticks.
+ * 
+ * Each word holds one bit per axon, packed 64 axons per uint64_t as in BitWord.
+ * The words form a ring indexed by tick, whose depth is max_tick_offset rounded
+ * up to a power of two so that a tick's word is found with a mask. Only
+ * max_tick_offset words of it are ever in use, so the Scheduler rejects a
+ * spike that would land max_tick_offset ticks ahead, where it collides with
+ * the current word in hardware. Traces and warnings report the hardware word,
+ * tick modulo max_tick_offset.
+ */
 class SchedulerSRAM{
 	public:
 		// Default Constructor
-		SchedulerSRAM(Scheduler* scheduler);
+		SchedulerSRAM();
 
-		void write(int word, int bit);
+		// Sets `bit` in the word `ticks_ahead` ticks after the current one. Returns false if it was already set.
+		bool write(int ticks_ahead, int bit);
+		// Same as write, but safe while other threads write to this SRAM. The bit is set with an atomic OR,
+		// and the previous value of the word tells whether it was already set.
+		bool writeShared(int ticks_ahead, int bit);
 
-		std::vector<bool> getCurrentWord();
+		// The current word, valid until it is cleared
+		const uint64_t* getCurrentWord() const { return &data[(curr_tick & mask) * num_words]; }
 		void clearCurrentWord();
-		void updateCurrentWord();
+		void updateCurrentWord(int tick);
+
+		// Number of spikes waiting in the current word and in all words
+		int currentWordPending() { return word_pending[curr_tick & mask]; }
+		int pending() { return total_pending; }
+
+		// The index of the word for `tick` in an SRAM of max_tick_offset words
+		static int hardwareWord(int tick);
 
 		std::string to_string();
 	private:
-		std::vector<std::vector<bool>> data;
-		int curr_word_index;
-		Scheduler* scheduler;
+		std::string wordBits(int slot);
+
+		// `depth` words of `num_words` each
+		std::vector<uint64_t> data;
+		int num_words;
+		int depth;
+		int mask;
+		int curr_tick;
+		std::vector<int> word_pending;
+		int total_pending;
 };
 
 #endif
@@ -0,0 +1,55 @@
+/// schedulerwheel.cpp
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#include <algorithm>
+
+#include "schedulerwheel.h"
+#include "bitword.hpp"
+#include "config.hpp"
+
+SchedulerWheel::SchedulerWheel() {
+	int depth = 1;
+	while (depth < Config::parameters.max_tick_offset) {
+		depth *= 2;
+	}
+	mask = depth - 1;
+	slots = std::vector<std::vector<int>>(depth);
+	current_word = std::vector<uint64_t>(BitWord::numWords(Config::parameters.num_axons));
+	total_pending = 0;
+	curr_tick = -1;
+}
+
+bool SchedulerWheel::write(int ticks_ahead, int bit) {
+	std::vector<int>& slot = slots[(curr_tick + ticks_ahead) & mask];
+	if (std::find(slot.begin(), slot.end(), bit) != slot.end()) {
+		return false;
+	}
+	slot.push_back(bit);
+	total_pending++;
+	return true;
+}
+
+void SchedulerWheel::clearCurrentWord() {
+	int slot = curr_tick & mask;
+	unpackSlot(slot);
+	total_pending -= slots[slot].size();
+	slots[slot].clear();
+}
+
+void SchedulerWheel::updateCurrentWord(int tick) {
+	// Unpack the previous slot, in case it was skipped without being cleared
+	unpackSlot(curr_tick & mask);
+	curr_tick = tick;
+	for (int bit : slots[curr_tick & mask]) {
+		BitWord::set(&current_word[0], bit);
+	}
+}
+
+void SchedulerWheel::unpackSlot(int slot) {
+	for (int bit : slots[slot]) {
+		current_word[bit / BitWord::BITS_PER_WORD] = 0;
+	}
+}
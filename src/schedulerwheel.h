@@ -0,0 +1,51 @@
+/// schedulerwheel.h
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#ifndef SCHEDULERWHEEL_H
+#define SCHEDULERWHEEL_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief A sparse alternative to SchedulerSRAM for cores that receive few spikes.
+ * 
+ * Instead of a bitmap of every axon for every tick, the wheel keeps a short
+ * list of the axons that received a spike for each of its slots, indexed by
+ * tick with a power-of-two mask like SchedulerSRAM. Duplicates are found by
+ * scanning the slot's list. The current slot is expanded into a single packed
+ * word when the wheel advances, so readers see the same word as they would
+ * from SchedulerSRAM, and only its set bits are cleared afterwards.
+ */
+class SchedulerWheel {
+	public:
+		SchedulerWheel();
+
+		// Adds `bit` to the slot `ticks_ahead` ticks after the current one. Returns false if it was already there.
+		bool write(int ticks_ahead, int bit);
+
+		// The current slot as a packed word, valid until it is cleared
+		const uint64_t* getCurrentWord() const { return &current_word[0]; }
+		void clearCurrentWord();
+		void updateCurrentWord(int tick);
+
+		// Number of spikes waiting in the current slot and in all slots
+		int currentWordPending() { return slots[curr_tick & mask].size(); }
+		int pending() { return total_pending; }
+
+	private:
+		// Clears the bits of `current_word` set from `slot`
+		void unpackSlot(int slot);
+
+		std::vector<std::vector<int>> slots;
+		int mask;
+		int curr_tick;
+		int total_pending;
+		// The axons of the current slot, packed as in BitWord
+		std::vector<uint64_t> current_word;
+};
+
+#endif // SCHEDULERWHEEL_H
@@ -0,0 +1,163 @@
+/// threadpool.cpp
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#include <chrono>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "threadpool.h"
+
+ThreadPool::ThreadPool(int num_threads) : queues(num_threads) {
+	this->batch = 0;
+	this->busy_workers = 0;
+	this->stopping = false;
+	this->task = NULL;
+	this->stealing = true;
+
+	ThreadStats no_work = {0, 0, 0.0};
+	stats = std::vector<ThreadStats>(num_threads, no_work);
+	for (auto& queue : queues) {
+		queue.front = 0;
+		queue.back = 0;
+	}
+	for (int thread = 1; thread < num_threads; thread++) {
+		workers.push_back(std::thread(&ThreadPool::work, this, thread));
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	started.notify_all();
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::run(int num_tasks, const std::function<void(int)>& task) {
+	runBatch(num_tasks, task, true);
+}
+
+void ThreadPool::runOnEachThread(const std::function<void(int)>& task) {
+	runBatch(size(), task, false);
+}
+
+bool ThreadPool::pin(int thread, const std::vector<int>& cpus) {
+#ifdef __linux__
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	for (int cpu : cpus) {
+		CPU_SET(cpu, &cpu_set);
+	}
+	pthread_t handle = thread == 0 ? pthread_self() : workers[thread - 1].native_handle();
+	return pthread_setaffinity_np(handle, sizeof(cpu_set), &cpu_set) == 0;
+#else
+	return false;
+#endif
+}
+
+void ThreadPool::runBatch(int num_tasks, const std::function<void(int)>& task, bool stealing) {
+	// Not worth waking the workers for
+	if (workers.empty() || num_tasks <= 1) {
+		for (int i = 0; i < num_tasks; i++) {
+			task(i);
+		}
+		stats[0].tasks += num_tasks;
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->task = &task;
+		this->stealing = stealing;
+		for (int thread = 0; thread < (int)queues.size(); thread++) {
+			queues[thread].front = num_tasks * thread / queues.size();
+			queues[thread].back = num_tasks * (thread + 1) / queues.size();
+		}
+		busy_workers = workers.size();
+		batch++;
+	}
+	started.notify_all();
+
+	runTasks(0);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [this] { return busy_workers == 0; });
+}
+
+void ThreadPool::work(int thread) {
+	int last_batch = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			started.wait(lock, [this, last_batch] { return stopping || batch != last_batch; });
+			if (stopping) {
+				return;
+			}
+			last_batch = batch;
+		}
+
+		runTasks(thread);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--busy_workers == 0) {
+			finished.notify_one();
+		}
+	}
+}
+
+void ThreadPool::runTasks(int thread) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int next_task;
+	while (true) {
+		if (take(thread, next_task)) {
+			(*task)(next_task);
+			stats[thread].tasks++;
+		} else if (!stealing || !steal(thread)) {
+			break;
+		}
+	}
+	stats[thread].busy_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool ThreadPool::take(int thread, int& task) {
+	TaskQueue& queue = queues[thread];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.front == queue.back) {
+		return false;
+	}
+	task = queue.front++;
+	return true;
+}
+
+bool ThreadPool::steal(int thread) {
+	for (int offset = 1; offset < (int)queues.size(); offset++) {
+		TaskQueue& victim = queues[(thread + offset) % queues.size()];
+		int front, back;
+		{
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (victim.front == victim.back) {
+				continue;
+			}
+			back = victim.back;
+			front = back - (back - victim.front + 1) / 2;
+			victim.back = front;
+		}
+
+		TaskQueue& queue = queues[thread];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.front = front;
+		queue.back = back;
+		stats[thread].steals++;
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,84 @@
+/// threadpool.h
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A fixed set of worker threads that run batches of numbered tasks.
+ * 
+ * run deals the tasks of a batch out to the threads in equal runs of
+ * consecutive indices, the calling thread included, and returns once every
+ * task has finished, which acts as a barrier between the phases of a tick.
+ * Each thread works through its own run from the front. A thread that runs
+ * out steals the back half of another thread's remaining run, so a caller
+ * that sizes its tasks to take about equal time gets an even split, and
+ * uneven tasks are rebalanced as they go. Tasks can finish in any order, so
+ * anything they produce that must be ordered should be kept per task and
+ * merged by the caller in task order.
+ */
+class ThreadPool {
+	public:
+		// Starts `num_threads` - 1 workers, the calling thread being the first thread.
+		ThreadPool(int num_threads);
+		~ThreadPool();
+
+		int size() { return queues.size(); }
+		// Calls `task` with every index from 0 to `num_tasks` - 1 and waits for all of them to return.
+		void run(int num_tasks, const std::function<void(int)>& task);
+		// Calls `task` with the index of each thread on that thread, without stealing, and waits for all of them
+		// to return. Used for work that has to stay with the thread that owns it.
+		void runOnEachThread(const std::function<void(int)>& task);
+		// Restricts `thread` to the CPUs in `cpus`. Returns false if the platform does not support it.
+		bool pin(int thread, const std::vector<int>& cpus);
+
+		// Work done by a thread over every batch so far
+		struct ThreadStats {
+			long long tasks;
+			long long steals;
+			// Time from the start of each batch until the thread found no more tasks to run or steal
+			double busy_seconds;
+		};
+		// Indexed by thread, the calling thread first
+		std::vector<ThreadStats> stats;
+
+	private:
+		// The tasks a thread has left, from `front` up to `back`
+		struct TaskQueue {
+			std::mutex mutex;
+			int front;
+			int back;
+		};
+
+		void runBatch(int num_tasks, const std::function<void(int)>& task, bool stealing);
+		void work(int thread);
+		void runTasks(int thread);
+		// Takes the next task from the front of the thread's own queue
+		bool take(int thread, int& task);
+		// Moves the back half of another thread's queue into the thread's own, which must be empty
+		bool steal(int thread);
+
+		std::vector<std::thread> workers;
+		std::vector<TaskQueue> queues;
+		std::mutex mutex;
+		std::condition_variable started;
+		std::condition_variable finished;
+		// Counts the batches started so far, so that a waking worker can tell a new batch from a spurious wakeup
+		int batch;
+		int busy_workers;
+		bool stopping;
+
+		const std::function<void(int)>* task;
+		bool stealing;
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,96 @@
+/// tilepartition.cpp
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "tilepartition.h"
+
+TilePartition::TilePartition(int num_cores_x, int num_cores_y, int num_tiles) {
+	// Pick the factoring of the largest usable tile count whose tiles are closest to square
+	tiles_x = 1;
+	tiles_y = 1;
+	for (int tiles = std::min(num_tiles, num_cores_x * num_cores_y); tiles > 1 && tiles_x * tiles_y == 1; tiles--) {
+		double best_aspect = 0;
+		for (int x = 1; x <= tiles; x++) {
+			int y = tiles / x;
+			if (x * y != tiles || x > num_cores_x || y > num_cores_y) {
+				continue;
+			}
+			double width = (double)num_cores_x / x;
+			double height = (double)num_cores_y / y;
+			double aspect = std::max(width, height) / std::min(width, height);
+			if (best_aspect == 0 || aspect < best_aspect) {
+				best_aspect = aspect;
+				tiles_x = x;
+				tiles_y = y;
+			}
+		}
+	}
+
+	core_tiles = std::vector<int>(num_cores_x * num_cores_y);
+	for (int y = 0; y < num_cores_y; y++) {
+		for (int x = 0; x < num_cores_x; x++) {
+			core_tiles[x + y * num_cores_x] = (x * tiles_x / num_cores_x) + (y * tiles_y / num_cores_y) * tiles_x;
+		}
+	}
+
+	node_cpus = readNodeCpus();
+}
+
+const std::vector<int>& TilePartition::cpusOf(int tile) {
+	static const std::vector<int> unknown;
+	if (node_cpus.size() < 2) {
+		return unknown;
+	}
+	return node_cpus[tile * node_cpus.size() / numTiles()];
+}
+
+// Parses a sysfs list of comma separated ranges, such as 0-7,16-23
+static std::vector<int> parseList(const std::string& list) {
+	std::vector<int> values;
+	std::stringstream ranges(list);
+	std::string range;
+	while (std::getline(ranges, range, ',')) {
+		int first, last;
+		int matched = std::sscanf(range.c_str(), "%d-%d", &first, &last);
+		if (matched < 1) {
+			continue;
+		}
+		if (matched == 1) {
+			last = first;
+		}
+		for (int value = first; value <= last; value++) {
+			values.push_back(value);
+		}
+	}
+	return values;
+}
+
+static std::string readLine(const std::string& file_name) {
+	std::ifstream file(file_name);
+	std::string line;
+	if (file.is_open()) {
+		std::getline(file, line);
+	}
+	return line;
+}
+
+// Node numbers can have gaps, so the online nodes are listed first. Nodes without CPUs, which only
+// hold memory, cannot run a thread and are skipped.
+std::vector<std::vector<int>> TilePartition::readNodeCpus() {
+	std::vector<std::vector<int>> nodes;
+	for (int node: parseList(readLine("/sys/devices/system/node/online"))) {
+		std::vector<int> cpus = parseList(readLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+		if (!cpus.empty()) {
+			nodes.push_back(cpus);
+		}
+	}
+	return nodes;
+}
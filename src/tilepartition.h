@@ -0,0 +1,46 @@
+/// tilepartition.h
+/// 
+/// Created for the University of Arizona Reconfigurable Computing Lab
+///
+///
+
+#ifndef TILEPARTITION_H
+#define TILEPARTITION_H
+
+#include <vector>
+
+/**
+ * @brief Splits the grid of cores into rectangular tiles, one for each thread.
+ * 
+ * The tiles are laid out in a tiles_x by tiles_y grid chosen to keep them as
+ * close to square as the thread count allows, and numbered in row-major order,
+ * so that consecutive tiles are neighbours on the mesh. Spikes mostly travel a
+ * few cores, so most of them stay within a tile or go to the next one.
+ * 
+ * Threads are spread over the NUMA nodes in order of their tile, so each node
+ * owns a band of adjacent tiles. The nodes and their CPUs are read from sysfs,
+ * and when they cannot be read every thread is treated as being on one node.
+ */
+class TilePartition {
+	public:
+		// Splits a `num_cores_x` by `num_cores_y` grid into at most `num_tiles` tiles. Fewer are used when
+		// `num_tiles` cannot be factored into a grid that fits.
+		TilePartition(int num_cores_x, int num_cores_y, int num_tiles);
+
+		int numTiles() { return tiles_x * tiles_y; }
+		// The tile of the core at index x + y * num_cores_x
+		int tileOf(int core) { return core_tiles[core]; }
+		// The CPUs of the NUMA node that the thread owning `tile` should run on, or an empty list if unknown
+		const std::vector<int>& cpusOf(int tile);
+
+		int tiles_x, tiles_y;
+
+	private:
+		// Reads the CPU list of every online NUMA node that has CPUs from sysfs
+		static std::vector<std::vector<int>> readNodeCpus();
+
+		std::vector<int> core_tiles;
+		std::vector<std::vector<int>> node_cpus;
+};
+
+#endif // TILEPARTITION_H
@@ -11,11 +11,20 @@
 #include <plog/Log.h>
 
 #include "tokencontroller.h"
+#include "bitword.hpp"
+#include "corekernel.h"
 #include "packet.h"
 #include "config.hpp"
 
+TokenController::IntegrationOrder TokenController::integration_order = TokenController::AUTO;
 
-TokenController::TokenController(Core* parent, Router* router, Scheduler* scheduler, NeuronBlock* neuron_block, std::vector<CSRAMRow*> csram, std::vector<int> neuron_instructions) {
+// Relative costs of neuron-major integration per word of axons and of axon-major integration per
+// spike. They put the crossover at one spike for every two axons, an estimate that rough timings
+// of a 256x256 crossbar with the AVX2 and AVX-512 kernels agree with but do not pin down.
+static const int NEURON_MAJOR_WORD_COST = 32;
+static const int AXON_MAJOR_SPIKE_COST = 1;
+
+TokenController::TokenController(Core* parent, Router* router, Scheduler* scheduler, NeuronBlock* neuron_block, CSRAM* csram, std::vector<int> neuron_instructions) {
 	this->parent = parent;
 	this->router = router;
 	this->scheduler = scheduler;
@@ -23,16 +32,34 @@ TokenController::TokenController(Core* parent, Router* router, Scheduler* schedu
 	this->csram = csram;
 
 	this->neuron_instructions = neuron_instructions;
+
+	int num_words = BitWord::numWords(neuron_instructions.size());
+	axon_type_masks = std::vector<uint64_t>(Config::parameters.num_weights * num_words);
+	for (int axon = 0; axon < (int)neuron_instructions.size(); axon++) {
+		BitWord::set(&axon_type_masks[neuron_instructions[axon] * num_words], axon);
+	}
+	fired_words = std::vector<uint64_t>(BitWord::numWords(csram->num_neurons));
+	axon_synapses = std::vector<int>(csram->num_axons);
+	for (int axon = 0; axon < csram->num_axons; axon++) {
+		for (int word = 0; word < csram->num_neuron_words; word++) {
+			axon_synapses[axon] += BitWord::popcount(csram->axonColumn(axon)[word]);
+		}
+	}
+	active_synapses = 0;
+	spike_words = NULL;
+	kernel = CoreKernel::forGeometry(csram);
+	synced_tick = -1;
+	scheduleNextEvent();
 }
 
 std::string TokenController::getSpikes() {
 	std::string str;
 	std::stringstream sstream;
 	char *pEnd = NULL;
-	for (int i = 0; i < Config::parameters["num_axons"].GetInt(); i += 4) {
+	for (int i = 0; i < Config::parameters.num_axons; i += 4) {
 		str = "";
-		for (int j = 0; j < 4; j++) {
-			str += std::to_string(spikes[i+j]);
+		for (int j = 0; j < 4 && i + j < Config::parameters.num_axons; j++) {
+			str += std::to_string(BitWord::test(spike_words, i + j));
 		}
 		int temp = (int)std::strtol(str.c_str(), &pEnd, 2);
 		sstream << std::hex << temp;
@@ -41,21 +68,40 @@ std::string TokenController::getSpikes() {
 	return sstream.str();
 }
 
-void TokenController::run() {
-	std::vector<int> active_connection_indices;
-	int neuron_block_trace_verbosity = Config::parameters["neuron_block_trace_verbosity"].GetInt();
+void TokenController::run(int tick, std::string* output) {
+	// Catch up on the ticks skipped since the last run, during which neurons only leaked
+	if (tick - 1 > synced_tick) {
+		csram->applyLeak(tick - 1 - synced_tick);
+	}
+	synced_tick = tick;
+
+	int neuron_block_trace_verbosity = Config::parameters.neuron_block_trace_verbosity;
 	
 	// Fetch the current spikes from the sram
-	spikes = scheduler->getSpikes();
+	spike_words = scheduler->getSpikes();
+	int num_words = csram->num_axon_words;
 
-	if (Config::parameters["token_controller_trace_verbosity"].GetInt()) {
+	// Skip integration entirely when no axon received a spike
+	int spike_count = kernel.count_spikes(csram, spike_words);
+	bool any_spikes = spike_count > 0;
+
+	active_synapses = 0;
+	for (int word = 0; any_spikes && word < num_words; word++) {
+		uint64_t spiking_axons = spike_words[word];
+		while (spiking_axons) {
+			active_synapses += axon_synapses[word * BitWord::BITS_PER_WORD + BitWord::countTrailingZeros(spiking_axons)];
+			spiking_axons &= spiking_axons - 1;
+		}
+	}
+
+	if (Config::parameters.token_controller_trace_verbosity) {
 		std::ostringstream sstream;
 		sstream << "++++++ Token Controller (" << parent->x << ", " << parent->y << ") running. Fetched spikes ";
 		std::ostringstream spike_stream;
-		for (auto bit : spikes) {
-			spike_stream << std::to_string(bit);
+		for (int axon = 0; axon < Config::parameters.num_axons; axon++) {
+			spike_stream << BitWord::test(spike_words, axon);
 		}
-		if (Config::parameters["token_controller_trace_verbosity"] == 1) {
+		if (Config::parameters.token_controller_trace_verbosity == 1) {
 			sstream << spike_stream.str();
 		}
 		// TODO: Include outputting in hex
@@ -67,77 +113,181 @@ void TokenController::run() {
 	// So that we only print cores whose neurons have spikes
 	bool wrote_core = false;
 
-	// Iterate through each neuron
-	for (auto csram_row = csram.begin(); csram_row != csram.end(); csram_row++) {
+	if (!neuron_block_trace_verbosity) {
+		// Integrate every neuron, then leak, threshold and reset all of them at once
+		if (any_spikes && axonMajorIsCheaper(spike_count)) {
+			kernel.integrate_axon_major(csram, spike_words, &neuron_instructions[0]);
+		} else if (any_spikes) {
+			kernel.integrate_neuron_major(csram, spike_words, &axon_type_masks[0], &neuron_instructions[0]);
+		}
 
-		neuron_block->current_potential = (*csram_row)->current_potential;
-		// Get active connecitons (where there is both a spike and connection)
-		active_connection_indices = activeConnectionIndices((*csram_row)->connections, spikes);
+		kernel.leak_and_fire(csram, &fired_words[0]);
 
-		if (neuron_block_trace_verbosity == 2) {
-			std::ostringstream sstream;
-			sstream << "Neuron " << csram_row - csram.begin() << " received spikes at axons ";
-			for (auto active_connection_index : active_connection_indices) {
-				sstream << active_connection_index << " ";
+		for (int word = 0; word < (int)fired_words.size(); word++) {
+			uint64_t fired = fired_words[word];
+			while (fired) {
+				emitSpike(word * BitWord::BITS_PER_WORD + BitWord::countTrailingZeros(fired), wrote_core, output);
+				fired &= fired - 1;
 			}
-			LOG_DEBUG_(1) << sstream.str();
 		}
+	} else {
+		// Iterate through each neuron one at a time so that each step can be traced
+		for (int neuron = 0; neuron < csram->num_neurons; neuron++) {
 
-		if (neuron_block_trace_verbosity == 1) {
-			LOG_DEBUG_(1) << "Neuron " << csram_row - csram.begin() << " integration";
-			LOG_DEBUG_(1) << "\tStarting potential: " << neuron_block->current_potential;
-		}
+			neuron_block->current_potential = csram->current_potential.get(neuron);
 
-		// Integrate spikes
-		for (auto active_connection_index : active_connection_indices) {
-			neuron_block->integrate((*csram_row)->weights, neuron_instructions[active_connection_index]);
+			if (neuron_block_trace_verbosity == 2) {
+				LOG_DEBUG_(1) << "Neuron " << neuron << " received spikes at axons " << activeConnectionIndices(csram->connectionRow(neuron));
+			}
 
 			if (neuron_block_trace_verbosity == 1) {
-				LOG_DEBUG_(1) << "\tIntegrated spike from axon " << active_connection_index << " with weight " << (*csram_row)->weights[neuron_instructions[active_connection_index]] << ". Current potential: " << neuron_block->current_potential;
+				LOG_DEBUG_(1) << "Neuron " << neuron << " integration";
+				LOG_DEBUG_(1) << "\tStarting potential: " << neuron_block->current_potential;
 			}
-		}
-		
-		// Apply leak
-		neuron_block->leak((*csram_row)->leak);
 
-		if (neuron_block_trace_verbosity == 1) {
-			LOG_DEBUG_(1) << "\tApplied leak of: " << (*csram_row)->leak << ". Current potential: " << neuron_block->current_potential;
-		}
+			// Integrate spikes at active connections (where there is both a spike and connection)
+			const uint64_t* connections = csram->connectionRow(neuron);
+			bool integrated = !any_spikes;
+			if (any_spikes && neuron_block_trace_verbosity == 2) {
+				integrated = neuron_block->integrateByType(csram->weightRow(neuron), csram->num_weights, connections, spike_words, &axon_type_masks[0], num_words);
+			}
+			// Integrate one spike at a time so that each one can be traced, or because the potential saturates
+			for (int word = 0; !integrated && word < num_words; word++) {
+				uint64_t active = connections[word] & spike_words[word];
+				while (active) {
+					int active_connection_index = word * BitWord::BITS_PER_WORD + BitWord::countTrailingZeros(active);
+					active &= active - 1;
 
-		// Check for spike
-		if (neuron_block->spikes((*csram_row)->positive_threshold)) {
-			// Log core if necessary
-			if (!wrote_core) {
-				LOG_INFO_(0) << "\tCore (" << parent->x << ", " << parent->y << "):";
-				wrote_core = true;
+					neuron_block->integrate(csram->weightRow(neuron), neuron_instructions[active_connection_index]);
+					if (neuron_block_trace_verbosity == 1) {
+						LOG_DEBUG_(1) << "\tIntegrated spike from axon " << active_connection_index << " with weight " << csram->weightRow(neuron)[neuron_instructions[active_connection_index]] << ". Current potential: " << neuron_block->current_potential;
+					}
+				}
 			}
-			// Log neuron to output
-			LOG_INFO_(0) << "\t\tNeuron " << csram_row - csram.begin();
+		
+			// Apply leak
+			neuron_block->leak(csram->leak.get(neuron));
+
 			if (neuron_block_trace_verbosity == 1) {
-				LOG_DEBUG_(1) << "\tNeuron spikes.";
+				LOG_DEBUG_(1) << "\tApplied leak of: " << csram->leak.get(neuron) << ". Current potential: " << neuron_block->current_potential;
 			}
 
-			router->receiveLocal(Packet((*csram_row)->dx, (*csram_row)->dy, (*csram_row)->destination_tick, (*csram_row)->destination_axon));
-		}
+			// Check for spike
+			if (neuron_block->spikes(csram->positive_threshold.get(neuron))) {
+				if (neuron_block_trace_verbosity == 1) {
+					LOG_DEBUG_(1) << "\tNeuron spikes.";
+				}
+				emitSpike(neuron, wrote_core, output);
+			}
 
-		// Send potential back to csram
-		(*csram_row)->current_potential  = neuron_block->output_potential((*csram_row)->positive_threshold, (*csram_row)->negative_threshold, (*csram_row)->reset_potential, (*csram_row)->reset_mode);
+			// Send potential back to csram
+			csram->current_potential.set(neuron, neuron_block->output_potential(csram->positive_threshold.get(neuron), csram->negative_threshold.get(neuron), csram->reset_potential.get(neuron), csram->reset_mode.get(neuron)));
 		
-		if (neuron_block_trace_verbosity == 1) {
-			LOG_DEBUG_(1) << "\tNeuron ends at potential: " << (*csram_row)->current_potential;
+			if (neuron_block_trace_verbosity == 1) {
+				LOG_DEBUG_(1) << "\tNeuron ends at potential: " << csram->current_potential.get(neuron);
+			}
 		}
 	}
 
 	// Clear SRAM after processing
 	scheduler->clear();
+
+	scheduleNextEvent();
 }
 
-std::vector<int> TokenController::activeConnectionIndices(std::vector<bool> connections, std::vector<bool> spikes) {
-	std::vector<int> indices;
-	for (int i = 0; i < connections.size(); i++) {
-		if (connections.at(i) && spikes.at(i)) {
-			indices.push_back(i);
+// Returns whether running on `tick` could produce output: there are spikes to integrate or a
+// neuron spikes or resets from leak alone.
+bool TokenController::hasWork(int tick) {
+	return tick >= next_event_tick || scheduler->hasCurrentSpikes();
+}
+
+void TokenController::scheduleNextEvent() {
+	// Events too far away to fit in a tick are the same as none
+	long long event_tick = (long long)synced_tick + csram->ticksUntilEvent();
+	next_event_tick = event_tick >= NEVER ? NEVER : event_tick;
+}
+
+// Neuron-major integration does a fixed amount of work per neuron and word of axons, while axon-major
+// integration does a vector pass over the neurons for each spike.
+bool TokenController::axonMajorIsCheaper(int spike_count) {
+	if (integration_order != AUTO) {
+		return integration_order == AXON_MAJOR;
+	}
+	return spike_count * AXON_MAJOR_SPIKE_COST <= csram->num_axon_words * NEURON_MAJOR_WORD_COST;
+}
+
+void TokenController::resolveDestinations(const std::vector<Core*>& cores) {
+	destination_cores.resize(csram->num_neurons);
+	destination_schedulers.resize(csram->num_neurons);
+	for (int neuron = 0; neuron < csram->num_neurons; neuron++) {
+		int x = parent->x + csram->dx[neuron];
+		int y = parent->y + csram->dy[neuron];
+		destination_cores[neuron] = x + y * Config::parameters.num_cores_x;
+		// Cores of other processes are left out, and their spikes always go through the outbox
+		if (cores[destination_cores[neuron]] != NULL) {
+			destination_schedulers[neuron] = cores[destination_cores[neuron]]->scheduler;
+			if (csram->canSpike(neuron)) {
+				destination_schedulers[neuron]->fan_in++;
+			}
 		}
 	}
-	return indices;
+}
+
+void TokenController::relocate() {
+	neuron_instructions = std::vector<int>(neuron_instructions);
+	axon_type_masks = std::vector<uint64_t>(axon_type_masks);
+	fired_words = std::vector<uint64_t>(fired_words);
+	axon_synapses = std::vector<int>(axon_synapses);
+	destination_cores = std::vector<int>(destination_cores);
+	destination_schedulers = std::vector<Scheduler*>(destination_schedulers);
+}
+
+bool TokenController::usesOutbox() {
+	return Router::routing_mode != Router::MESH && !Config::traceSpecified();
+}
+
+// Writes a spike of `neuron` to the output and sends it to its destination scheduler, either now or
+// through the outbox, or to the router when routing through the mesh.
+void TokenController::emitSpike(int neuron, bool& wrote_core, std::string* output) {
+	// Log core if necessary, then the neuron
+	if (output != NULL) {
+		if (!wrote_core) {
+			*output += "\tCore (" + std::to_string(parent->x) + ", " + std::to_string(parent->y) + "):\n";
+			wrote_core = true;
+		}
+		*output += "\t\tNeuron " + std::to_string(neuron) + "\n";
+	} else {
+		if (!wrote_core) {
+			LOG_INFO_(0) << "\tCore (" << parent->x << ", " << parent->y << "):";
+			wrote_core = true;
+		}
+		LOG_INFO_(0) << "\t\tNeuron " << neuron;
+	}
+
+	if (Router::routing_mode == Router::MESH) {
+		router->receiveLocal(Packet(csram->dx[neuron], csram->dy[neuron], csram->destination_tick[neuron], csram->destination_axon[neuron]));
+		return;
+	}
+	if (usesOutbox()) {
+		AddressedSpike spike = {destination_cores[neuron], csram->destination_tick[neuron], csram->destination_axon[neuron]};
+		outbox.push_back(spike);
+		return;
+	}
+	if (Router::recordsRoutes()) {
+		Router::recordRoute(parent->x, parent->y, csram->dx[neuron], csram->dy[neuron]);
+	}
+	destination_schedulers[neuron]->receiveSpike(csram->destination_tick[neuron], csram->destination_axon[neuron]);
+}
+
+// Lists the axons at which `connections` and the current spikes are both set, separated by spaces.
+std::string TokenController::activeConnectionIndices(const uint64_t* connections) {
+	std::ostringstream sstream;
+	for (int word = 0; word < csram->num_axon_words; word++) {
+		uint64_t active = connections[word] & spike_words[word];
+		while (active) {
+			sstream << word * BitWord::BITS_PER_WORD + BitWord::countTrailingZeros(active) << " ";
+			active &= active - 1;
+		}
+	}
+	return sstream.str();
 }
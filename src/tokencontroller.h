@@ -7,25 +7,61 @@
 #ifndef TOKENCONTROLLER_H
 #define TOKENCONTROLLER_H
 
+#include <climits>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include "core.h"
 #include "router.h"
-#include "csramrow.h"
+#include "csram.h"
 #include "scheduler.h"
 #include "neuronblock.h"
+#include "corekernel.h"
+
+// A spike for an axon of a core, waiting in an outbox or the input to be written to the core's scheduler
+struct AddressedSpike {
+	// Index of the destination core, x + y * num_cores_x
+	int destination_core;
+	int delivery_tick;
+	int destination_axon;
+};
 
 class TokenController {
 	public:		
 		// Default Constructor
-		TokenController(Core* parent, Router* router, Scheduler* scheduler, NeuronBlock* neuron_block, std::vector<CSRAMRow*> csram, std::vector<int> neuron_instructions);		
+		TokenController(Core* parent, Router* router, Scheduler* scheduler, NeuronBlock* neuron_block, CSRAM* csram, std::vector<int> neuron_instructions);		
 
 		// Setters
 		void setAxonType(int idx, int type);
+		// Looks up the scheduler each neuron's spikes are written to in `cores`, indexed by x + y * num_cores_x
+		void resolveDestinations(const std::vector<Core*>& cores);
+		// Copies the per-core tables into memory allocated by the calling thread
+		void relocate();
 
 		// Computation Functions
-		void run();
+		// Runs the core for `tick`. The neurons that spike are appended to `output` if it is set, or logged
+		// straight to the output file otherwise.
+		void run(int tick, std::string* output);
+		bool hasWork(int tick);
+		// The tick on which a neuron will next spike or reset without input, or NEVER
+		int nextEventTick() { return next_event_tick; }
+		static const int NEVER = INT_MAX;
+		// Number of connections the spikes of the last run reached, which estimates how long the next run takes
+		int activeSynapses() { return active_synapses; }
+
+		// Spikes emitted by the last run, when they are delivered after every core has run. Their routes
+		// are recorded when they are delivered, so cores with an outbox can run in parallel.
+		std::vector<AddressedSpike> outbox;
+		// Whether spikes are collected in `outbox` rather than written to their scheduler as they are emitted.
+		// Traces log each write with the neuron that caused it, so traced runs deliver immediately.
+		static bool usesOutbox();
+
+		// How spikes are integrated into neurons. NEURON_MAJOR scans each neuron's CSRAM row against the
+		// spikes, AXON_MAJOR adds each spiking axon's weights down its crossbar column, and AUTO picks the
+		// cheaper of the two for each core on each tick from the number of spikes.
+		enum IntegrationOrder { AUTO, NEURON_MAJOR, AXON_MAJOR };
+		static IntegrationOrder integration_order;
 
 		// Debug Functions
 		std::string getSpikes();
@@ -33,7 +69,7 @@ class TokenController {
 		std::vector<int> neuron_instructions;
 
 		// The core's components
-		std::vector<CSRAMRow*> csram;
+		CSRAM* csram;
 		Scheduler* scheduler;
 		Router* router;		
 		NeuronBlock* neuron_block;
@@ -43,9 +79,29 @@ class TokenController {
 		// int x, y;
 
 	private:
-		std::vector<int> activeConnectionIndices(std::vector<bool> connections, std::vector<bool> spikes);
-		// Vector of which axon's are active
-		std::vector<bool> spikes;
+		bool axonMajorIsCheaper(int spike_count);
+		void emitSpike(int neuron, bool& wrote_core, std::string* output);
+		std::string activeConnectionIndices(const uint64_t* connections);
+		// The scheduler's current word of spikes, packed 64 axons per word so that it can be AND-ed with
+		// a CSRAM row's connections. Points into the scheduler until it is cleared at the end of run.
+		const uint64_t* spike_words;
+		// Packed mask of the axons of each type, one `spike_words`-sized word per type
+		std::vector<uint64_t> axon_type_masks;
+		// Packed set of the neurons that spiked this tick
+		std::vector<uint64_t> fired_words;
+		// Number of neurons each axon connects to
+		std::vector<int> axon_synapses;
+		int active_synapses;
+		// The index and scheduler of each neuron's destination core, used instead of the router unless routing through the mesh
+		std::vector<int> destination_cores;
+		std::vector<Scheduler*> destination_schedulers;
+		// The untraced integrate, leak and fire steps, specialized for the CSRAM's geometry when possible
+		CoreKernel::Functions kernel;
+		// The last tick whose leak has been applied to the CSRAM. Ticks without input before
+		// `next_event_tick` are skipped, and their leak is applied in one step by the next run.
+		int synced_tick;
+		int next_event_tick;
+		void scheduleNextEvent();
 };
 
 #endif //TOKENCONTROLLER_H
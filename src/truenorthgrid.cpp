@@ -5,6 +5,8 @@
 ///
 
 #include <iostream>
+#include <algorithm>
+#include <cstring>
 
 #include <plog/Log.h>
 
@@ -15,14 +17,118 @@
 #include "neuronblock.h"
 #include "csramrow.h"
 #include "tokencontroller.h"
+#include "linkcounters.h"
+#include "nocmodel.h"
+
+int TrueNorthGrid::num_threads = 1;
+TrueNorthGrid::Partition TrueNorthGrid::partition = TrueNorthGrid::RUNS;
+TrueNorthGrid::Delivery TrueNorthGrid::delivery = TrueNorthGrid::PARTITIONED;
+HaloExchange* TrueNorthGrid::halo_exchange = NULL;
+
+// Fewest active cores, and fewest spikes to write, worth handing to a thread of their own
+static const int MIN_CORES_PER_RUN = 4;
+static const int MIN_SPIKES_PER_RUN = 1024;
+// Runs of cores each thread starts with, so that threads that finish early have runs to steal
+static const int RUNS_PER_THREAD = 4;
 
 TrueNorthGrid::TrueNorthGrid(std::vector<std::vector<Packet*>> input_packets, std::vector<Core*> cores) {
 	this->cores = cores;
-	this->input_packets = input_packets;
+	this->worklist = NULL;
+	this->pool = NULL;
+	this->tiles = NULL;
+	this->reported_warnings = 0;
+	this->remote_warnings = Scheduler::Warnings();
+
+	// Input packets are addressed from core (0, 0), so their offsets are the destination's coordinates.
+	// Each tick's packets are grouped by destination core so that they can be written straight to
+	// the schedulers, keeping their order within each core. Traces log the writes in input order. Each
+	// process only keeps the packets for its own cores.
+	input_spikes.resize(input_packets.size());
+	for (int tick = 0; tick < (int)input_packets.size(); tick++) {
+		for (auto packet: input_packets[tick]) {
+			AddressedSpike spike = {packet->dx + packet->dy * Config::parameters.num_cores_x, packet->delivery_tick, packet->destination_axon};
+			if (isLocal(spike.destination_core)) {
+				input_spikes[tick].push_back(spike);
+			}
+			delete packet;
+		}
+		if (!Config::traceSpecified()) {
+			std::stable_sort(input_spikes[tick].begin(), input_spikes[tick].end(), [](const AddressedSpike& a, const AddressedSpike& b) { return a.destination_core < b.destination_core; });
+		}
+	}
+
+	next_input_tick.resize(input_spikes.size() + 1);
+	next_input_tick[input_spikes.size()] = input_spikes.size();
+	for (int tick = input_spikes.size() - 1; tick >= 0; tick--) {
+		next_input_tick[tick] = input_spikes[tick].empty() ? next_input_tick[tick + 1] : tick;
+	}
+
+	// A core can receive a spike from each neuron that sends to it and each input packet of a tick
+	std::vector<int> max_input_packets(cores.size());
+	std::vector<int> tick_input_packets(cores.size());
+	for (auto& tick_spikes: input_spikes) {
+		for (const AddressedSpike& spike: tick_spikes) {
+			tick_input_packets[spike.destination_core]++;
+			max_input_packets[spike.destination_core] = std::max(max_input_packets[spike.destination_core], tick_input_packets[spike.destination_core]);
+		}
+		for (const AddressedSpike& spike: tick_spikes) {
+			tick_input_packets[spike.destination_core] = 0;
+		}
+	}
+	for (int i = 0; i < (int)cores.size(); i++) {
+		if (cores[i] != NULL) {
+			cores[i]->scheduler->chooseStorage(cores[i]->scheduler->fan_in + max_input_packets[i]);
+		}
+	}
+
+	if (!Config::traceSpecified()) {
+		this->worklist = new CoreWorklist(cores, Config::parameters.num_cores_x);
+	}
+	if (TokenController::usesOutbox()) {
+		this->pool = new ThreadPool(num_threads);
+	}
+
+	// Pin each tile's thread to its node, then let it copy the state of its cores so that the pages are
+	// first touched there
+	if (pool != NULL && pool->size() > 1 && partition == TILES) {
+		this->tiles = new TilePartition(Config::parameters.num_cores_x, Config::parameters.num_cores_y, pool->size());
+		int num_tiles = tiles->numTiles();
+		std::vector<std::vector<Core*>> tile_cores(num_tiles);
+		for (int i = 0; i < (int)cores.size(); i++) {
+			if (cores[i] != NULL) {
+				tile_cores[tiles->tileOf(i)].push_back(cores[i]);
+			}
+		}
+		int unpinned = 0;
+		for (int tile = 0; tile < num_tiles; tile++) {
+			if (!tiles->cpusOf(tile).empty() && !pool->pin(tile, tiles->cpusOf(tile))) {
+				unpinned++;
+			}
+		}
+		if (unpinned > 0) {
+			std::cout << "[WARNING] Could not pin " << unpinned << " of " << num_tiles << " threads to their NUMA node, so they run on any CPU." << std::endl;
+		}
+		pool->runOnEachThread([num_tiles, &tile_cores](int tile) {
+			for (int i = 0; tile < num_tiles && i < (int)tile_cores[tile].size(); i++) {
+				tile_cores[tile][i]->relocate();
+			}
+		});
+
+		tile_active_cores.resize(num_tiles);
+		tile_spikes.resize(num_tiles * num_tiles);
+		core_outputs.resize(cores.size());
+	}
+
+	if (halo_exchange != NULL) {
+		halo_outgoing.resize(halo_exchange->num_processes);
+		remote_core_warnings.resize(cores.size());
+	}
 }
 
 void TrueNorthGrid::beginActivity(int num_ticks, int report_frequency) {
-	std::cout << "Starting simulation with " << num_ticks << " ticks." << std::endl;
+	if (isFirstProcess()) {
+		std::cout << "Starting simulation with " << num_ticks << " ticks." << std::endl;
+	}
 	
 	if (Config::traceSpecified()) {
 		LOG_DEBUG_(1) << "Starting simulation with " << num_ticks << " ticks.";
@@ -31,30 +137,532 @@ void TrueNorthGrid::beginActivity(int num_ticks, int report_frequency) {
 	// FIXME: max_tick_offset of 16 will actually correspond to a max of 15 ticks in the future being able to be specified. We need error checking for this as well.
 
 	// Iterate through each tick
-	for (unsigned int tick = 0; tick < num_ticks; tick++) {
-		if (tick % report_frequency == 0) {
-			std::cout << "Tick " << tick + 1 << " started" << std::endl;
+	for (int tick = 0; tick < num_ticks; tick++) {
+		// When no core has pending spikes or a neuron event coming up, the network stays at rest until
+		// the next input packets or event, so the ticks before then only write their empty output. Split
+		// grids exchange on every tick, since another process may be busy.
+		if (worklist != NULL && halo_exchange == NULL) {
+			int next_tick = std::min(worklist->nextBusyTick(tick), tick < (int)input_spikes.size() ? next_input_tick[tick] : num_ticks);
+			for (; tick < next_tick && tick < num_ticks; tick++) {
+				startTick(tick, report_frequency);
+				endTick(tick);
+			}
+			if (tick == num_ticks) {
+				break;
+			}
 		}
 
-		LOG_INFO_(0) << "Tick " << tick + 1 << ":";
+		startTick(tick, report_frequency);
 
 		if (Config::traceSpecified()) {
 			LOG_DEBUG_(1) << "-------------------- Tick " << tick + 1 << " begins --------------------";
 		}
 
-		for (auto core_iter: cores) {
-			core_iter->scheduler->updateCurrentWord();
+		if (worklist != NULL) {
+			worklist->beginTick(tick);
+		} else {
+			for (auto core_iter: cores) {
+				core_iter->scheduler->updateCurrentWord(tick);
+			}
 		}
 
 		// Receive all input spike packets destined for this tick	
-		std::vector<Packet*>::iterator packet_iter;
-		for (auto packet_iter: input_packets[tick]) {
-			cores.front()->router->receiveLocal(*packet_iter);
+		if (Router::recordsRoutes()) {
+			for (const AddressedSpike& spike: input_spikes[tick]) {
+				Router::recordRoute(0, 0, spike.destination_core % Config::parameters.num_cores_x, spike.destination_core / Config::parameters.num_cores_x);
+			}
 		}
+		deliver(input_spikes[tick]);
 		
-		// Next loop through all cores, simulating a tick. Performs all neuron block operations
-		for (auto core_iter: cores) {
-			core_iter->token_controller->run();
+		// Next loop through all cores, simulating a tick. Performs all neuron block operations. The spikes
+		// they emit wait in their outboxes until every core has run.
+		if (tiles != NULL) {
+			runTiles(tick);
+			exchangeHalo();
+			exchangeTiles();
+			deliver(halo_spikes);
+			worklist->endTick();
+		} else if (pool != NULL) {
+			runCores(tick);
+			exchangeHalo();
+			deliverOutboxes(worklist->activeCores());
+			deliver(halo_spikes);
+			worklist->endTick();
+		} else if (worklist != NULL) {
+			for (auto core_iter: worklist->activeCores()) {
+				if (core_iter->token_controller->hasWork(tick)) {
+					core_iter->token_controller->run(tick, NULL);
+				}
+			}
+			worklist->endTick();
+		} else {
+			for (auto core_iter: cores) {
+				core_iter->token_controller->run(tick, NULL);
+			}
+			deliverOutboxes(cores);
 		}
+
+		endTick(tick);
 	}	
+
+	if (Router::link_counters != NULL) {
+		Router::link_counters->finish(num_ticks);
+	}
+
+	gatherResults();
+	if (isFirstProcess()) {
+		reportWarnings(true);
+	}
+}
+
+void TrueNorthGrid::startTick(int tick, int report_frequency) {
+	if (tick % report_frequency == 0) {
+		gatherWarnings();
+	}
+	if (!isFirstProcess()) {
+		return;
+	}
+	if (tick % report_frequency == 0) {
+		reportWarnings(false);
+		std::cout << "Tick " << tick + 1 << " started" << std::endl;
+	}
+
+	LOG_INFO_(0) << "Tick " << tick + 1 << ":";
+}
+
+void TrueNorthGrid::endTick(int tick) {
+	if (Router::link_counters != NULL) {
+		Router::link_counters->endTick(tick);
+	}
+	if (Router::noc_model != NULL) {
+		Router::noc_model->endTick(tick);
+	}
+}
+
+void TrueNorthGrid::reportWarnings(bool final) {
+	Scheduler::Warnings total = Scheduler::total_warnings;
+	total.current_word += remote_warnings.current_word;
+	total.duplicate += remote_warnings.duplicate;
+	if (total.current_word + total.duplicate == 0 || (!final && total.current_word + total.duplicate == reported_warnings)) {
+		return;
+	}
+	reported_warnings = total.current_word + total.duplicate;
+
+	std::cout << "Schedulers dropped " << total.current_word << " spikes for the current tick and " << total.duplicate << " duplicate spikes";
+	if (!final) {
+		std::cout << " so far." << std::endl;
+		return;
+	}
+
+	int warned_cores = 0;
+	int worst = -1;
+	Scheduler::Warnings worst_warnings = Scheduler::Warnings();
+	for (int i = 0; i < (int)cores.size(); i++) {
+		Scheduler::Warnings warnings = cores[i] != NULL ? cores[i]->scheduler->warnings : remote_core_warnings[i];
+		if (warnings.current_word + warnings.duplicate == 0) {
+			continue;
+		}
+		warned_cores++;
+		if (worst == -1 || warnings.current_word + warnings.duplicate > worst_warnings.current_word + worst_warnings.duplicate) {
+			worst = i;
+			worst_warnings = warnings;
+		}
+	}
+	int num_cores_x = Config::parameters.num_cores_x;
+	std::cout << " on " << warned_cores << " cores, most on core (" << worst % num_cores_x << ", " << worst / num_cores_x << ") with " << worst_warnings.current_word << " and " << worst_warnings.duplicate << ".";
+	if (Scheduler::warning_samples > 0 && reported_warnings > Scheduler::warning_samples) {
+		std::cout << " Only the first " << Scheduler::warning_samples << " were printed.";
+	}
+	std::cout << std::endl;
+}
+
+void TrueNorthGrid::runCores(int tick) {
+	const std::vector<Core*>& active_cores = worklist->activeCores();
+	int num_runs = pool->size() == 1 ? 1 : std::min(pool->size() * RUNS_PER_THREAD, std::max(1, (int)active_cores.size() / MIN_CORES_PER_RUN));
+	outputs.resize(num_runs);
+
+	// Cut the cores into runs of about equal work, estimated from the connections each core's spikes
+	// reached on its last run on top of updating every neuron
+	run_starts.assign(num_runs + 1, active_cores.size());
+	run_starts[0] = 0;
+	long long total_work = 0;
+	for (auto core_iter: active_cores) {
+		total_work += core_iter->csram->num_neurons + core_iter->token_controller->activeSynapses();
+	}
+	long long work = 0;
+	for (int i = 0, run = 1; i < (int)active_cores.size() && run < num_runs; i++) {
+		work += active_cores[i]->csram->num_neurons + active_cores[i]->token_controller->activeSynapses();
+		for (; run < num_runs && work * num_runs >= total_work * run; run++) {
+			run_starts[run] = i + 1;
+		}
+	}
+
+	pool->run(num_runs, [this, tick, &active_cores](int run) {
+		for (int i = run_starts[run]; i < run_starts[run + 1]; i++) {
+			if (active_cores[i]->token_controller->hasWork(tick)) {
+				active_cores[i]->token_controller->run(tick, &outputs[run]);
+			}
+		}
+	});
+
+	std::string& output = outputs[0];
+	for (int run = 1; run < num_runs; run++) {
+		output += outputs[run];
+		outputs[run].clear();
+	}
+	writeOutput(output);
+}
+
+void TrueNorthGrid::runTiles(int tick) {
+	const std::vector<Core*>& active_cores = worklist->activeCores();
+	int num_cores_x = Config::parameters.num_cores_x;
+	for (auto& tile_cores: tile_active_cores) {
+		tile_cores.clear();
+	}
+	for (auto core_iter: active_cores) {
+		tile_active_cores[tiles->tileOf(core_iter->x + core_iter->y * num_cores_x)].push_back(core_iter);
+	}
+
+	pool->runOnEachThread([this, tick, num_cores_x](int tile) {
+		for (int i = 0; tile < (int)tile_active_cores.size() && i < (int)tile_active_cores[tile].size(); i++) {
+			Core* core = tile_active_cores[tile][i];
+			if (core->token_controller->hasWork(tick)) {
+				core->token_controller->run(tick, &core_outputs[core->x + core->y * num_cores_x]);
+			}
+		}
+	});
+
+	outputs.resize(1);
+	std::string& output = outputs[0];
+	for (auto core_iter: active_cores) {
+		std::string& core_output = core_outputs[core_iter->x + core_iter->y * num_cores_x];
+		output += core_output;
+		core_output.clear();
+	}
+	writeOutput(output);
+}
+
+void TrueNorthGrid::exchangeTiles() {
+	// Writes stay serial while drops are still printed, as in deliver
+	Scheduler::Warnings& total = Scheduler::total_warnings;
+	if (Scheduler::strict_warnings || total.current_word + total.duplicate < Scheduler::warning_samples) {
+		deliverOutboxes(worklist->activeCores());
+		return;
+	}
+	if (Router::recordsRoutes()) {
+		recordRoutes(worklist->activeCores());
+	}
+
+	int num_tiles = tile_active_cores.size();
+	pool->runOnEachThread([this, num_tiles](int tile) {
+		for (int i = 0; tile < num_tiles && i < (int)tile_active_cores[tile].size(); i++) {
+			std::vector<AddressedSpike>& outbox = tile_active_cores[tile][i]->token_controller->outbox;
+			for (const AddressedSpike& spike: outbox) {
+				tile_spikes[tile * num_tiles + tiles->tileOf(spike.destination_core)].push_back(spike);
+			}
+			outbox.clear();
+		}
+	});
+
+	// Waking a core changes the worklist, so every destination is woken before the writes start
+	for (const std::vector<AddressedSpike>& spikes: tile_spikes) {
+		for (const AddressedSpike& spike: spikes) {
+			worklist->wake(cores[spike.destination_core]);
+		}
+	}
+
+	std::vector<Scheduler::Warnings> tile_warnings(num_tiles);
+	Scheduler::concurrent_writes = true;
+	pool->runOnEachThread([this, num_tiles, &tile_warnings](int tile) {
+		for (int source = 0; tile < num_tiles && source < num_tiles; source++) {
+			std::vector<AddressedSpike>& spikes = tile_spikes[source * num_tiles + tile];
+			Scheduler::Warnings dropped = deliverRange(spikes, 0, spikes.size());
+			tile_warnings[tile].current_word += dropped.current_word;
+			tile_warnings[tile].duplicate += dropped.duplicate;
+			spikes.clear();
+		}
+	});
+	Scheduler::concurrent_writes = false;
+	for (const Scheduler::Warnings& warnings: tile_warnings) {
+		total.current_word += warnings.current_word;
+		total.duplicate += warnings.duplicate;
+	}
+}
+
+// Each line of the output ends in a newline, except the last, which the output file adds
+void TrueNorthGrid::writeOutput(std::string& output) {
+	if (!isFirstProcess()) {
+		halo_output += output;
+		output.clear();
+	} else if (!output.empty()) {
+		output.pop_back();
+		LOG_INFO_(0) << output;
+		output.clear();
+	}
+}
+
+bool TrueNorthGrid::isLocal(int core) {
+	return halo_exchange == NULL || halo_exchange->ownerOfRow(core / Config::parameters.num_cores_x) == halo_exchange->rank;
+}
+
+// Halo messages are the raw bytes of the values in them, since every process runs the same binary
+template <typename T>
+static void appendBytes(std::string& message, const T* values, size_t count) {
+	message.append((const char*)values, sizeof(T) * count);
+}
+
+template <typename T>
+static void readBytes(const std::string& message, size_t& offset, T* values, size_t count) {
+	if (offset + sizeof(T) * count > message.size()) {
+		throw HaloExchangeException("Received a truncated message from another process.");
+	}
+	memcpy(values, message.data() + offset, sizeof(T) * count);
+	offset += sizeof(T) * count;
+}
+
+// Each message holds the spikes for the receiver's cores and, to process 0 only, the sender's output for
+// the tick. Process 0 writes the outputs in rank order, which is
+// core order, after its own.
+void TrueNorthGrid::exchangeHalo() {
+	if (halo_exchange == NULL) {
+		return;
+	}
+	int num_cores_x = Config::parameters.num_cores_x;
+	for (auto core_iter: worklist->activeCores()) {
+		std::vector<AddressedSpike>& outbox = core_iter->token_controller->outbox;
+		int kept = 0;
+		for (const AddressedSpike& spike: outbox) {
+			int owner = halo_exchange->ownerOfRow(spike.destination_core / num_cores_x);
+			if (owner == halo_exchange->rank) {
+				outbox[kept++] = spike;
+				continue;
+			}
+			if (Router::recordsRoutes()) {
+				Router::recordRoute(core_iter->x, core_iter->y, spike.destination_core % num_cores_x - core_iter->x, spike.destination_core / num_cores_x - core_iter->y);
+			}
+			halo_outgoing[owner].push_back(spike);
+		}
+		outbox.resize(kept);
+	}
+
+	int num_processes = halo_exchange->num_processes;
+	std::vector<std::string> outgoing(num_processes), incoming(num_processes);
+	for (int peer = 0; peer < num_processes; peer++) {
+		if (peer == halo_exchange->rank) {
+			continue;
+		}
+		uint64_t num_spikes = halo_outgoing[peer].size();
+		appendBytes(outgoing[peer], &num_spikes, 1);
+		appendBytes(outgoing[peer], halo_outgoing[peer].data(), num_spikes);
+		if (peer == 0) {
+			outgoing[peer] += halo_output;
+		}
+		halo_outgoing[peer].clear();
+	}
+	halo_output.clear();
+
+	halo_exchange->exchange(outgoing, incoming);
+
+	halo_spikes.clear();
+	for (int peer = 0; peer < num_processes; peer++) {
+		if (peer == halo_exchange->rank) {
+			continue;
+		}
+		size_t offset = 0;
+		uint64_t num_spikes;
+		readBytes(incoming[peer], offset, &num_spikes, 1);
+		halo_spikes.resize(halo_spikes.size() + num_spikes);
+		readBytes(incoming[peer], offset, halo_spikes.data() + halo_spikes.size() - num_spikes, num_spikes);
+		if (isFirstProcess()) {
+			std::string output = incoming[peer].substr(offset);
+			writeOutput(output);
+		}
+	}
+	std::stable_sort(halo_spikes.begin(), halo_spikes.end(), [](const AddressedSpike& a, const AddressedSpike& b) { return a.destination_core < b.destination_core; });
+}
+
+void TrueNorthGrid::gatherWarnings() {
+	if (halo_exchange == NULL) {
+		return;
+	}
+	int num_processes = halo_exchange->num_processes;
+	std::vector<std::string> outgoing(num_processes), incoming(num_processes);
+	if (!isFirstProcess()) {
+		appendBytes(outgoing[0], &Scheduler::total_warnings, 1);
+	}
+
+	halo_exchange->exchange(outgoing, incoming);
+
+	remote_warnings = Scheduler::Warnings();
+	for (int peer = 1; isFirstProcess() && peer < num_processes; peer++) {
+		size_t offset = 0;
+		Scheduler::Warnings warnings;
+		readBytes(incoming[peer], offset, &warnings, 1);
+		remote_warnings.current_word += warnings.current_word;
+		remote_warnings.duplicate += warnings.duplicate;
+	}
+}
+
+// Process 0 reports the dropped spikes by core, so it keeps the counts of every other process's cores
+void TrueNorthGrid::gatherResults() {
+	if (halo_exchange == NULL) {
+		return;
+	}
+	int num_processes = halo_exchange->num_processes;
+	int num_cores_x = Config::parameters.num_cores_x;
+	std::vector<std::string> outgoing(num_processes), incoming(num_processes);
+	if (!isFirstProcess()) {
+		int rank = halo_exchange->rank;
+		for (int i = halo_exchange->firstRow(rank) * num_cores_x; i < halo_exchange->endRow(rank) * num_cores_x; i++) {
+			appendBytes(outgoing[0], &cores[i]->scheduler->warnings, 1);
+		}
+		appendBytes(outgoing[0], &Router::statistics, 1);
+	}
+
+	halo_exchange->exchange(outgoing, incoming);
+
+	if (!isFirstProcess()) {
+		return;
+	}
+	remote_warnings = Scheduler::Warnings();
+	for (int peer = 1; peer < num_processes; peer++) {
+		size_t offset = 0;
+		for (int i = halo_exchange->firstRow(peer) * num_cores_x; i < halo_exchange->endRow(peer) * num_cores_x; i++) {
+			Scheduler::Warnings& warnings = remote_core_warnings[i];
+			readBytes(incoming[peer], offset, &warnings, 1);
+			Scheduler::total_warnings.current_word += warnings.current_word;
+			Scheduler::total_warnings.duplicate += warnings.duplicate;
+		}
+		Router::Statistics statistics;
+		readBytes(incoming[peer], offset, &statistics, 1);
+		Router::statistics.packets += statistics.packets;
+		Router::statistics.hops += statistics.hops;
+		Router::statistics.max_hops = std::max(Router::statistics.max_hops, statistics.max_hops);
+	}
+}
+
+void TrueNorthGrid::deliverOutboxes(const std::vector<Core*>& sources) {
+	if (!TokenController::usesOutbox()) {
+		return;
+	}
+	bool any_spikes = false;
+	for (auto core_iter: sources) {
+		any_spikes |= !core_iter->token_controller->outbox.empty();
+	}
+	if (!any_spikes) {
+		return;
+	}
+
+	if (Router::recordsRoutes()) {
+		recordRoutes(sources);
+	}
+
+	// Counting sort by destination core, so that spikes for the same core keep the order they were emitted in
+	bucket_starts.assign(cores.size() + 1, 0);
+	for (auto core_iter: sources) {
+		for (const AddressedSpike& spike: core_iter->token_controller->outbox) {
+			bucket_starts[spike.destination_core + 1]++;
+		}
+	}
+	for (int i = 0; i < (int)cores.size(); i++) {
+		bucket_starts[i + 1] += bucket_starts[i];
+	}
+	deliveries.resize(bucket_starts[cores.size()]);
+	for (auto core_iter: sources) {
+		std::vector<AddressedSpike>& outbox = core_iter->token_controller->outbox;
+		for (const AddressedSpike& spike: outbox) {
+			deliveries[bucket_starts[spike.destination_core]++] = spike;
+		}
+		outbox.clear();
+	}
+
+	deliver(deliveries);
+}
+
+// Records the route of every spike in the outboxes of `sources` in the order they were emitted, as if each
+// had been sent as soon as it was.
+void TrueNorthGrid::recordRoutes(const std::vector<Core*>& sources) {
+	for (auto core_iter: sources) {
+		for (const AddressedSpike& spike: core_iter->token_controller->outbox) {
+			Router::recordRoute(core_iter->x, core_iter->y, spike.destination_core % Config::parameters.num_cores_x - core_iter->x, spike.destination_core / Config::parameters.num_cores_x - core_iter->y);
+		}
+	}
+}
+
+void TrueNorthGrid::deliver(const std::vector<AddressedSpike>& spikes) {
+	// Drops are printed in the order they happen, so writes stay serial while samples are left
+	Scheduler::Warnings& total = Scheduler::total_warnings;
+	bool samples_left = Scheduler::strict_warnings || total.current_word + total.duplicate < Scheduler::warning_samples;
+	int num_runs = pool != NULL ? std::min(pool->size(), (int)spikes.size() / MIN_SPIKES_PER_RUN) : 1;
+	if (num_runs <= 1 || samples_left) {
+		deliverRange(spikes, 0, spikes.size());
+		return;
+	}
+
+	// Waking a core changes the worklist, so every destination is woken before the writes start
+	std::vector<Scheduler*> destinations;
+	std::vector<Scheduler::Warnings> destination_warnings;
+	for (int i = 0; i < (int)spikes.size(); i++) {
+		if (i == 0 || spikes[i].destination_core != spikes[i - 1].destination_core) {
+			worklist->wake(cores[spikes[i].destination_core]);
+			if (delivery == ATOMIC) {
+				destinations.push_back(cores[spikes[i].destination_core]->scheduler);
+				destination_warnings.push_back(destinations.back()->warnings);
+			}
+		}
+	}
+
+	// Each run ends on a change of destination core, so no two threads write to the same scheduler. With
+	// atomic delivery, runs only move to the next change of destination core if the scheduler is sparse.
+	std::vector<int> spike_starts(num_runs + 1);
+	for (int run = 0; run <= num_runs; run++) {
+		int start = spikes.size() * run / num_runs;
+		while (start > 0 && start < (int)spikes.size() && spikes[start].destination_core == spikes[start - 1].destination_core
+				&& (delivery == PARTITIONED || cores[spikes[start].destination_core]->scheduler->isSparse())) {
+			start++;
+		}
+		spike_starts[run] = start;
+	}
+	if (delivery == ATOMIC) {
+		// Runs can share a scheduler, so drops are counted from each destination's warnings afterwards
+		Scheduler::concurrent_writes = true;
+		Scheduler::shared_writes = true;
+		pool->run(num_runs, [this, &spikes, &spike_starts](int run) {
+			for (int i = spike_starts[run]; i < spike_starts[run + 1]; i++) {
+				cores[spikes[i].destination_core]->scheduler->receiveSpike(spikes[i].delivery_tick, spikes[i].destination_axon);
+			}
+		});
+		Scheduler::shared_writes = false;
+		Scheduler::concurrent_writes = false;
+		for (int i = 0; i < (int)destinations.size(); i++) {
+			total.current_word += destinations[i]->warnings.current_word - destination_warnings[i].current_word;
+			total.duplicate += destinations[i]->warnings.duplicate - destination_warnings[i].duplicate;
+		}
+		return;
+	}
+	std::vector<Scheduler::Warnings> run_warnings(num_runs);
+	Scheduler::concurrent_writes = true;
+	pool->run(num_runs, [this, &spikes, &spike_starts, &run_warnings](int run) {
+		run_warnings[run] = deliverRange(spikes, spike_starts[run], spike_starts[run + 1]);
+	});
+	Scheduler::concurrent_writes = false;
+	for (const Scheduler::Warnings& warnings: run_warnings) {
+		total.current_word += warnings.current_word;
+		total.duplicate += warnings.duplicate;
+	}
+}
+
+Scheduler::Warnings TrueNorthGrid::deliverRange(const std::vector<AddressedSpike>& spikes, int begin, int end) {
+	Scheduler::Warnings dropped = {0, 0};
+	for (int i = begin; i < end; ) {
+		Scheduler* scheduler = cores[spikes[i].destination_core]->scheduler;
+		Scheduler::Warnings before = scheduler->warnings;
+		int destination_core = spikes[i].destination_core;
+		for (; i < end && spikes[i].destination_core == destination_core; i++) {
+			scheduler->receiveSpike(spikes[i].delivery_tick, spikes[i].destination_axon);
+		}
+		dropped.current_word += scheduler->warnings.current_word - before.current_word;
+		dropped.duplicate += scheduler->warnings.duplicate - before.duplicate;
+	}
+	return dropped;
 }
\ No newline at end of file
@@ -11,16 +11,107 @@
 #include <string>
 
 #include "core.h"
+#include "coreworklist.h"
 #include "packet.h"
+#include "tokencontroller.h"
+#include "threadpool.h"
+#include "tilepartition.h"
+#include "haloexchange.h"
 
 class TrueNorthGrid{
 	public:
 		TrueNorthGrid(std::vector<std::vector<Packet*>> input_packets, std::vector<Core*> cores);
 
 		void beginActivity(int num_ticks, int report_frequency);
+		// The threads the cores run on, or NULL if they run on the calling thread only
+		ThreadPool* threadPool() { return pool; }
+
+		// Number of threads the cores of a tick are run on when their spikes go through outboxes
+		static int num_threads;
+		// How the cores are split between threads. RUNS balances contiguous runs of cores by their activity on
+		// every tick, and TILES gives each thread a fixed tile of the grid, whose state lives on its NUMA node.
+		enum Partition { RUNS, TILES };
+		static Partition partition;
+		// How the spikes of a tick are split between threads when written. PARTITIONED splits them at changes
+		// of destination core, so each scheduler is written by one thread. ATOMIC splits them evenly and lets
+		// threads share a dense scheduler, setting its bits with an atomic OR.
+		enum Delivery { PARTITIONED, ATOMIC };
+		static Delivery delivery;
+		// Set when the rows of the grid are split between processes, each of which runs its own grid
+		static HaloExchange* halo_exchange;
 	private:
-		std::vector<std::vector<Packet*>> input_packets; 
+		// Runs the active cores of `tick` in contiguous runs of cores spread over the pool, then writes their
+		// output in core order
+		void runCores(int tick);
+		// Where each run of cores starts in the active cores, and where the last one ends
+		std::vector<int> run_starts;
+		// Runs the active cores of `tick` on the thread owning their tile, then writes their output in core order
+		void runTiles(int tick);
+		// Sends the spikes in the outboxes of the active cores to the thread owning their destination through
+		// a buffer for each pair of tiles, which then writes them to their schedulers
+		void exchangeTiles();
+		// Writes `output`, whose lines all end in a newline, to the output file and clears it. Processes other
+		// than process 0 keep it to send with the tick's halo exchange.
+		void writeOutput(std::string& output);
+		// Sends the spikes in the outboxes of the active cores that are for another process's cores, and this
+		// process's output to process 0, then receives the same from the others
+		void exchangeHalo();
+		// Sends this process's dropped spike totals to process 0 for its progress report
+		void gatherWarnings();
+		// Sends the dropped spikes of each core and the routing statistics to process 0, which adds them to its own
+		void gatherResults();
+		// Whether the core at index x + y * num_cores_x belongs to this process
+		bool isLocal(int core);
+		// Whether this process prints progress and writes the output file
+		bool isFirstProcess() { return halo_exchange == NULL || halo_exchange->rank == 0; }
+		// Writes the output header and progress report of `tick`
+		void startTick(int tick, int report_frequency);
+		// Updates the link statistics and the mesh model at the end of `tick`
+		void endTick(int tick);
+		// Writes the spikes in the outboxes of `sources` to their schedulers, grouped by destination core
+		void deliverOutboxes(const std::vector<Core*>& sources);
+		void recordRoutes(const std::vector<Core*>& sources);
+		// Writes `spikes` to their schedulers, one run of spikes for the same core at a time. Once no more
+		// drops will be printed, spikes sorted by destination core are split between the pool's threads.
+		void deliver(const std::vector<AddressedSpike>& spikes);
+		// Writes the spikes from `begin` to `end`, returning how many their schedulers dropped
+		Scheduler::Warnings deliverRange(const std::vector<AddressedSpike>& spikes, int begin, int end);
+		// Prints the spikes the schedulers have dropped if there are new ones, or a summary by core at the end
+		void reportWarnings(bool final);
+		long long reported_warnings;
+
+		// The input packets of each tick, sorted by destination core unless tracing
+		std::vector<std::vector<AddressedSpike>> input_spikes;
+		// For each tick, the first tick from it on which input packets arrive, or the number of input ticks
+		std::vector<int> next_input_tick;
+		// Every core at x + y * num_cores_x, or NULL for the cores of other processes
 		std::vector<Core*> cores;		
+		// Only set when tracing is off, since traces log every core on every tick
+		CoreWorklist* worklist;
+		// Only set when cores deliver through their outboxes, since they can then run in any order
+		ThreadPool* pool;
+		// The output of each run of cores on the current tick
+		std::vector<std::string> outputs;
+		// Only set when partitioning into tiles
+		TilePartition* tiles;
+		// The active cores of each tile on the current tick, in core order
+		std::vector<std::vector<Core*>> tile_active_cores;
+		// The output of each core on the current tick
+		std::vector<std::string> core_outputs;
+		// The spikes from each tile to each tile, at source tile * number of tiles + destination tile
+		std::vector<std::vector<AddressedSpike>> tile_spikes;
+		// Spikes for other processes' cores on the current tick, by process, and those received from them,
+		// sorted by destination core
+		std::vector<std::vector<AddressedSpike>> halo_outgoing;
+		std::vector<AddressedSpike> halo_spikes;
+		// Output of this process's cores waiting to be sent to process 0
+		std::string halo_output;
+		// On process 0, the spikes dropped by the other processes so far, and by each of their cores at the end
+		Scheduler::Warnings remote_warnings;
+		std::vector<Scheduler::Warnings> remote_core_warnings;
+		// Every outbox of a tick, bucketed by destination core, and where each core's bucket starts
+		std::vector<AddressedSpike> deliveries;
+		std::vector<int> bucket_starts;
 };
 
 #endif